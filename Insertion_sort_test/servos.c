@@ -1,4 +1,84 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "servos.h"
+#include "sortNetworks.h"
+
+// Define constants
+#define PARALLEL_CUTOFF 20000       // Rough insertion sort steps (groups * length^2) below which threads don't pay.
+#define CHUNKS_PER_THREAD 8         // Chunks handed out per thread, more evens out the work but costs more atomics.
+#define CACHE_LINE 64
+#define KEYS_PER_LINE (CACHE_LINE / (int)sizeof(uint64_t))
+
+struct sortPool{
+    pthread_t* threads;             // The workers, one fewer than noOfThreads since the caller works too.
+    int noOfThreads;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t finished;
+    unsigned long generation;       // Goes up by one for each sort, so workers know there is a new one.
+    int stopping;
+    int busy;                       // Workers still on the current sort.
+    struct servoArrays job;
+    int chunk;                      // SubArrays taken at a time.
+    atomic_int next;                // First subArray nobody has taken yet.
+};
+
+/* The next edge of one group, waiting in the merge heap */
+struct edgeCursor{
+    double time;
+    int group;
+    int next;                       // Place in the group of the edge after this one.
+};
+
+/* Compare and exchange steps for the sorting networks. The servos are swapped by flipping the bits that differ under
+ * a mask rather than with selects, which gcc turns back into a branch that is mispredicted half the time on random
+ * times.
+ */
+#define SERVO_SWAP(i, j) { \
+    uint64_t timeI_, timeJ_, mask_ = -(uint64_t)(array[j].timerLen < array[i].timerLen); \
+    memcpy(&timeI_, &array[i].timerLen, sizeof(double)); memcpy(&timeJ_, &array[j].timerLen, sizeof(double)); \
+    uint64_t timeFlip_ = (timeI_ ^ timeJ_) & mask_; \
+    int pinFlip_ = (array[i].pinNo ^ array[j].pinNo) & (int)mask_; \
+    timeI_ ^= timeFlip_; timeJ_ ^= timeFlip_; \
+    memcpy(&array[i].timerLen, &timeI_, sizeof(double)); memcpy(&array[j].timerLen, &timeJ_, sizeof(double)); \
+    array[i].pinNo ^= pinFlip_; array[j].pinNo ^= pinFlip_; }
+#define KEY_SWAP(i, j) { \
+    uint64_t keyI_ = keys[i], keyJ_ = keys[j]; \
+    keys[i] = keyJ_ < keyI_ ? keyJ_ : keyI_; keys[j] = keyJ_ < keyI_ ? keyI_ : keyJ_; }
+
+// One function per network and layout, made from sortNetworks.h, only reached through the tables below.
+#define DEFINE_NETWORKS(n) \
+    static void servo_network_##n(struct servo array[]){ SORT_NETWORK_##n(SERVO_SWAP) } \
+    static void key_network_##n(uint64_t keys[]){ SORT_NETWORK_##n(KEY_SWAP) }
+
+DEFINE_NETWORKS(2) DEFINE_NETWORKS(3) DEFINE_NETWORKS(4) DEFINE_NETWORKS(5) DEFINE_NETWORKS(6) DEFINE_NETWORKS(7)
+DEFINE_NETWORKS(8) DEFINE_NETWORKS(9) DEFINE_NETWORKS(10) DEFINE_NETWORKS(11) DEFINE_NETWORKS(12)
+DEFINE_NETWORKS(13) DEFINE_NETWORKS(14) DEFINE_NETWORKS(15) DEFINE_NETWORKS(16)
+
+// The networks by length, NULL where there isn't one.
+static void (*const servoNetworks[SORT_NETWORK_MAX + 1])(struct servo array[]) = {
+    NULL, NULL, servo_network_2, servo_network_3, servo_network_4, servo_network_5, servo_network_6,
+    servo_network_7, servo_network_8, servo_network_9, servo_network_10, servo_network_11, servo_network_12,
+    servo_network_13, servo_network_14, servo_network_15, servo_network_16
+};
+static void (*const keyNetworks[SORT_NETWORK_MAX + 1])(uint64_t keys[]) = {
+    NULL, NULL, key_network_2, key_network_3, key_network_4, key_network_5, key_network_6, key_network_7,
+    key_network_8, key_network_9, key_network_10, key_network_11, key_network_12, key_network_13, key_network_14,
+    key_network_15, key_network_16
+};
+
+// Hidden function declarations
+void* sort_pool_worker(void* argument);
+void sort_chunks(struct sortPool* pool);
+void sift_down(struct edgeCursor heap[], int heapLen, int place);
 
 
 
@@ -12,6 +92,97 @@ void sort_arrays(struct servoArrays arrayOfArrays){
     }
 }
 
+// This function sorts all of the subArrays on a pool of threads, handing them out a chunk at a time
+void sort_arrays_parallel(struct servoArrays arrayOfArrays, struct sortPool* pool){
+    long long work = (long long)arrayOfArrays.noOfArrays * arrayOfArrays.arraysLen * arrayOfArrays.arraysLen;
+
+    if(pool == NULL || pool->noOfThreads == 1 || work < PARALLEL_CUTOFF){
+        sort_arrays(arrayOfArrays);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->job = arrayOfArrays;
+    pool->chunk = arrayOfArrays.noOfArrays / (pool->noOfThreads * CHUNKS_PER_THREAD);
+    if(pool->chunk < 1){
+        pool->chunk = 1;
+    }
+    atomic_store(&pool->next, 0);
+    pool->busy = pool->noOfThreads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    sort_chunks(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->busy > 0){
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// This function sorts every group of a servoBank by timer length
+void sort_bank(struct servoBank bank){
+    for(int i = 0; i < bank.noOfArrays; i++){
+        sort_keys(bank.entries + (size_t)i * bank.stride, bank.arraysLen);
+    }
+}
+
+// This function sorts an array of servo keys using insertion sort, shifting bigger keys up rather than swapping
+void sort_keys(uint64_t keys[], int keysLen){
+    for(int i = 1; i < keysLen; i++){
+        uint64_t key = keys[i];
+        int j = i;
+        while(j > 0 && keys[j-1] > key){
+            keys[j] = keys[j-1];
+            j--;
+        }
+        keys[j] = key;
+    }
+}
+
+// This function sorts all of the subArrays of a servoArrays with the sorting network for their length
+void sort_arrays_network(struct servoArrays arrayOfArrays){
+    if(arrayOfArrays.arraysLen < SORT_NETWORK_MIN || arrayOfArrays.arraysLen > SORT_NETWORK_MAX){
+        sort_arrays(arrayOfArrays);
+        return;
+    }
+    void (*network)(struct servo array[]) = servoNetworks[arrayOfArrays.arraysLen];
+    for(int i = 0; i < arrayOfArrays.noOfArrays; i++){
+        network(arrayOfArrays.servos[i]);
+    }
+}
+
+// This function sorts every group of a servoBank with the sorting network for the group length
+void sort_bank_network(struct servoBank bank){
+    if(bank.arraysLen < SORT_NETWORK_MIN || bank.arraysLen > SORT_NETWORK_MAX){
+        sort_bank(bank);
+        return;
+    }
+    void (*network)(uint64_t keys[]) = keyNetworks[bank.arraysLen];
+    for(int i = 0; i < bank.noOfArrays; i++){
+        network(bank.entries + (size_t)i * bank.stride);
+    }
+}
+
+// This function sorts a subarray of servos with the sorting network for its length, or insertion sort if there isn't one
+struct servo* sort_network(struct servo array[], int arraylen){
+    if(arraylen < SORT_NETWORK_MIN || arraylen > SORT_NETWORK_MAX){
+        return sort_insert(array, arraylen);
+    }
+    servoNetworks[arraylen](array);
+    return array;
+}
+
+// This function sorts servo keys with the sorting network for their length, or insertion sort if there isn't one
+void sort_keys_network(uint64_t keys[], int keysLen){
+    if(keysLen < SORT_NETWORK_MIN || keysLen > SORT_NETWORK_MAX){
+        sort_keys(keys, keysLen);
+        return;
+    }
+    keyNetworks[keysLen](keys);
+}
+
 // This function sorts a subarray of a servoArrays of servos using insertion sort
 struct servo* sort_insert (struct servo array[], int arraylen){
     for(int i = 1; i<arraylen; i++){
@@ -26,3 +197,273 @@ struct servo* sort_insert (struct servo array[], int arraylen){
     }
     return array;
 }
+
+
+//Servo bank functions
+
+// This function makes an empty servoBank in one block, aligned to a cache line
+struct servoBank bank_create(int noOfArrays, int arraysLen){
+    struct servoBank bank;
+    int stride = 1;
+
+    if(arraysLen > KEYS_PER_LINE){
+        stride = (arraysLen + KEYS_PER_LINE - 1) / KEYS_PER_LINE * KEYS_PER_LINE;
+    }
+    else{
+        while(stride < arraysLen){
+            stride *= 2;
+        }
+    }
+    bank.arraysLen = arraysLen;
+    bank.noOfArrays = noOfArrays;
+    bank.stride = stride;
+    bank.block = calloc((size_t)noOfArrays * stride * sizeof(uint64_t) + CACHE_LINE, 1);
+    bank.entries = NULL;
+    if(bank.block != NULL){
+        uintptr_t address = ((uintptr_t)bank.block + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        bank.entries = (uint64_t*)address;
+    }
+    return bank;
+}
+
+// This function frees the memory of a servoBank
+void bank_destroy(struct servoBank* bank){
+    free(bank->block);
+    bank->block = NULL;
+    bank->entries = NULL;
+}
+
+// This function makes a servoBank holding the same servos as a servoArrays, with timer lengths in ticks
+struct servoBank bank_from_arrays(struct servoArrays arrayOfArrays, double ticksPerUnit){
+    struct servoBank bank = bank_create(arrayOfArrays.noOfArrays, arrayOfArrays.arraysLen);
+
+    if(bank.entries == NULL){
+        return bank;
+    }
+    for(int i = 0; i < arrayOfArrays.noOfArrays; i++){
+        uint64_t* group = bank.entries + (size_t)i * bank.stride;
+        for(int j = 0; j < arrayOfArrays.arraysLen; j++){
+            double ticks = arrayOfArrays.servos[i][j].timerLen * ticksPerUnit + 0.5;
+            if(ticks < 0){
+                ticks = 0;
+            }
+            if(ticks > UINT32_MAX){
+                ticks = UINT32_MAX;
+            }
+            group[j] = SERVO_KEY((uint32_t)ticks, arrayOfArrays.servos[i][j].pinNo);
+        }
+    }
+    return bank;
+}
+
+// This function gives the bytes allocated for a servoBank
+size_t bank_bytes(struct servoBank bank){
+    return (size_t)bank.noOfArrays * bank.stride * sizeof(uint64_t) + CACHE_LINE;
+}
+
+// This function gives the bytes a servoArrays asks for when each subArray is allocated on its own
+size_t arrays_bytes(struct servoArrays arrayOfArrays){
+    return (size_t)arrayOfArrays.noOfArrays * (sizeof(struct servo*) + arrayOfArrays.arraysLen * sizeof(struct servo));
+}
+
+
+//Timeline functions
+
+// This function merges the sorted groups of a servoArrays into one time ordered list of falling edges with a heap
+int merge_edges(struct servoArrays arrayOfArrays, double slotLength, double guard, struct edgeTimeline* timeline){
+    int groupLen = arrayOfArrays.arraysLen;
+    int total = arrayOfArrays.noOfArrays * groupLen;
+    struct edgeCursor* heap = malloc(sizeof(struct edgeCursor) * (arrayOfArrays.noOfArrays + 1));
+    int heapLen = 0;
+    double previous = 0;
+
+    timeline->noOfEdges = 0;
+    timeline->noOfClashes = 0;
+    timeline->edges = malloc(sizeof(struct servoEdge) * (total + 1));
+    if(heap == NULL || timeline->edges == NULL){
+        free(heap);
+        free(timeline->edges);
+        timeline->edges = NULL;
+        return 0;
+    }
+    if(groupLen > 0){
+        for(int i = 0; i < arrayOfArrays.noOfArrays; i++){
+            heap[heapLen].time = i * slotLength + arrayOfArrays.servos[i][0].timerLen;
+            heap[heapLen].group = i;
+            heap[heapLen].next = 1;
+            heapLen++;
+        }
+    }
+    for(int i = heapLen / 2 - 1; i >= 0; i--){
+        sift_down(heap, heapLen, i);
+    }
+
+    while(heapLen > 0){
+        struct edgeCursor* top = &heap[0];
+        struct servoEdge* edge = &timeline->edges[timeline->noOfEdges];
+        edge->time = top->time;
+        edge->pinNo = arrayOfArrays.servos[top->group][top->next - 1].pinNo;
+        edge->group = top->group;
+        edge->tooClose = timeline->noOfEdges > 0 && edge->time - previous < guard;
+        previous = edge->time;
+        timeline->noOfClashes += edge->tooClose;
+        timeline->noOfEdges++;
+
+        if(top->next < groupLen){
+            // Replace the top with the group's next edge rather than popping and pushing.
+            top->time = top->group * slotLength + arrayOfArrays.servos[top->group][top->next].timerLen;
+            top->next++;
+        }
+        else{
+            heap[0] = heap[--heapLen];
+        }
+        sift_down(heap, heapLen, 0);
+    }
+    free(heap);
+    return 1;
+}
+
+// This function frees the edges of an edgeTimeline
+void timeline_destroy(struct edgeTimeline* timeline){
+    free(timeline->edges);
+    timeline->edges = NULL;
+    timeline->noOfEdges = 0;
+    timeline->noOfClashes = 0;
+}
+
+
+//Thread pool functions
+
+// This function starts a pool of threads for sort_arrays_parallel
+struct sortPool* sort_pool_create(int noOfThreads){
+    struct sortPool* pool = malloc(sizeof(struct sortPool));
+
+    if(noOfThreads <= 0){
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        noOfThreads = (int)info.dwNumberOfProcessors;
+#else
+        noOfThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if(noOfThreads < 1){
+            noOfThreads = 1;
+        }
+    }
+    if(pool == NULL){
+        return NULL;
+    }
+    pool->threads = malloc(sizeof(pthread_t) * noOfThreads);
+    if(pool->threads == NULL){
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    pool->generation = 0;
+    pool->stopping = 0;
+    pool->busy = 0;
+    pool->chunk = 1;
+    atomic_init(&pool->next, 0);
+    pool->noOfThreads = 1;
+    for(int i = 0; i < noOfThreads - 1; i++){
+        if(pthread_create(&pool->threads[i], NULL, sort_pool_worker, pool) != 0){
+            break;
+        }
+        pool->noOfThreads++;
+    }
+    return pool;
+}
+
+// This function stops the threads of a pool and frees it
+void sort_pool_destroy(struct sortPool* pool){
+    if(pool == NULL){
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for(int i = 0; i < pool->noOfThreads - 1; i++){
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->finished);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+
+// Hidden functions
+
+/**This function is run by each worker thread, it waits for a sort to start, helps with it, and waits again
+ * @param argument  The pool the thread belongs to
+ */
+void* sort_pool_worker(void* argument){
+    struct sortPool* pool = argument;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while(1){
+        while(pool->generation == seen && !pool->stopping){
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if(pool->stopping){
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        sort_chunks(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->busy--;
+        if(pool->busy == 0){
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**This function takes chunks of subArrays from the current sort and sorts them until there are none left
+ * @param pool      The pool running the sort
+ */
+void sort_chunks(struct sortPool* pool){
+    struct servoArrays job = pool->job;
+    int chunk = pool->chunk;
+    int first;
+
+    while((first = atomic_fetch_add(&pool->next, chunk)) < job.noOfArrays){
+        int last = first + chunk < job.noOfArrays ? first + chunk : job.noOfArrays;
+        for(int i = first; i < last; i++){
+            sort_insert(job.servos[i], job.arraysLen);
+        }
+    }
+}
+
+/**This function moves an edge down the merge heap until both the edges below it are later, ties going to the
+lower group so the merge is stable
+ * @param heap      The heap
+ * @param heapLen   The number of edges in the heap
+ * @param place     Where the edge to move is
+ */
+void sift_down(struct edgeCursor heap[], int heapLen, int place){
+    struct edgeCursor moving = heap[place];
+
+    while(2 * place + 1 < heapLen){
+        int child = 2 * place + 1;
+        if(child + 1 < heapLen && (heap[child + 1].time < heap[child].time ||
+           (heap[child + 1].time == heap[child].time && heap[child + 1].group < heap[child].group))){
+            child++;
+        }
+        if(heap[child].time > moving.time || (heap[child].time == moving.time && heap[child].group > moving.group)){
+            break;
+        }
+        heap[place] = heap[child];
+        place = child;
+    }
+    heap[place] = moving;
+}
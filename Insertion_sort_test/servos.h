@@ -1,3 +1,6 @@
+#include <stddef.h>
+#include <stdint.h>
+
 /* Contains all the information needed for each servo
  * pinNo    The number pin that this servo is connected to.
  * timerLen The amount of time that the pin needs to be high for this servo
@@ -13,6 +16,46 @@ struct servoArrays{
     struct servo** servos;
 };
 
+/* A servoArrays kept in one block of memory instead of one block per subArray.
+ * Each servo is a single key with its timer length in whole ticks in the top 32 bits and its pin in the bottom 32,
+ * so sorting keys as plain integers sorts by time and carries the pins along. Group i starts at entries[i*stride];
+ * the stride pads each group so a small one never straddles a cache line and a big one starts on a fresh one.
+ */
+struct servoBank{
+    int arraysLen;
+    int noOfArrays;
+    int stride;
+    uint64_t* entries;
+    void* block;            // What was allocated, entries is aligned within it.
+};
+
+#define SERVO_KEY(ticks, pin) (((uint64_t)(ticks) << 32) | (uint32_t)(pin))
+#define SERVO_KEY_TICKS(key) ((uint32_t)((key) >> 32))
+#define SERVO_KEY_PIN(key) ((int)(uint32_t)(key))
+
+/* One falling edge on the timeline of a whole servoArrays
+ * time     When the edge happens, counting from the start of the first group's slot
+ * tooClose 1 if it is closer than the guard time to the edge before it, so the two can't both be serviced on time
+ */
+struct servoEdge{
+    double time;
+    int pinNo;
+    int group;
+    int tooClose;
+};
+
+/* Every falling edge of a servoArrays in time order, and how many are too close to the one before */
+struct edgeTimeline{
+    int noOfEdges;
+    int noOfClashes;
+    struct servoEdge* edges;
+};
+
+/* A set of threads kept waiting to sort servoArrays, so the threads are started once rather than on every sort.
+ * The thread that calls sort_arrays_parallel works too.
+ */
+struct sortPool;
+
 // Function declarations
 
 /**This function will take a full servoArrays structure and sort all of the subArrays
@@ -30,3 +73,114 @@ void sort_arrays(struct servoArrays arrayOfArrays);
  * @return          The sorted array of servos
  */
 struct servo* sort_insert (struct servo array[], int arraylen);
+
+/**This function starts a pool of threads for sort_arrays_parallel
+ * @param noOfThreads   The number of threads, counting the one that sorts, 0 or less for one per core
+ *
+ * @return              The pool, or NULL if it could not be started
+ */
+struct sortPool* sort_pool_create(int noOfThreads);
+
+/**This function stops the threads of a pool and frees it
+ * @param pool      The pool to stop
+ */
+void sort_pool_destroy(struct sortPool* pool);
+
+/**This function sorts all of the subArrays of a servoArrays like sort_arrays, but on a pool of threads.
+The threads take the subArrays a chunk at a time, so each one does about the same amount of work. A servoArrays
+too small to be worth splitting up is sorted by sort_arrays on the calling thread.
+ * @param arrayOfArrays The servoArrays to be sorted
+ * @param pool          The pool to sort on, or NULL to sort on the calling thread
+ */
+void sort_arrays_parallel(struct servoArrays arrayOfArrays, struct sortPool* pool);
+
+/**This function makes an empty servoBank, with every key 0
+ * @param noOfArrays    The number of groups
+ * @param arraysLen     The number of servos in each group
+ *
+ * @return              The bank, with entries NULL if there was no memory
+ */
+struct servoBank bank_create(int noOfArrays, int arraysLen);
+
+/**This function frees the memory of a servoBank
+ * @param bank      The bank to free
+ */
+void bank_destroy(struct servoBank* bank);
+
+/**This function makes a servoBank holding the same servos as a servoArrays
+ * @param arrayOfArrays The servoArrays to copy
+ * @param ticksPerUnit  How many ticks one unit of timerLen is, times are rounded to the nearest tick and kept
+ *                      between 0 and UINT32_MAX
+ *
+ * @return              The bank, with entries NULL if there was no memory
+ */
+struct servoBank bank_from_arrays(struct servoArrays arrayOfArrays, double ticksPerUnit);
+
+/**This function gives the bytes of memory a servoBank uses
+ * @param bank      The bank
+ *
+ * @return          The bytes allocated for it
+ */
+size_t bank_bytes(struct servoBank bank);
+
+/**This function gives the bytes of memory a servoArrays uses if each subArray was allocated on its own, as main.c does
+ * @param arrayOfArrays The servoArrays
+ *
+ * @return              The bytes asked for, not counting what malloc adds to each of the noOfArrays + 1 blocks
+ */
+size_t arrays_bytes(struct servoArrays arrayOfArrays);
+
+/**This function sorts every group of a servoBank by timer length
+ * @param bank      The bank to be sorted
+ */
+void sort_bank(struct servoBank bank);
+
+/**This function sorts an array of servo keys using insertion sort
+ * @param keys      The keys
+ * @param keysLen   The number of keys
+ */
+void sort_keys(uint64_t keys[], int keysLen);
+
+/**This function merges the sorted groups of a servoArrays into one time ordered list of falling edges.
+Each group is switched on at the start of its own slot, so every edge in group i is moved on by i * slotLength. The
+groups are merged through a heap holding the next edge of each group, so it takes n log(noOfArrays) time for n servos.
+ * @param arrayOfArrays The servoArrays, with every subArray already sorted
+ * @param slotLength    The time from the start of one group to the start of the next, in the units of timerLen
+ * @param guard         The closest two edges can be and both still be serviced on time, such as the ISR time
+ * @param timeline      Filled in with the edges, free it with timeline_destroy
+ *
+ * @return              1 if it worked, 0 if there was no memory
+ */
+int merge_edges(struct servoArrays arrayOfArrays, double slotLength, double guard, struct edgeTimeline* timeline);
+
+/**This function frees the edges of an edgeTimeline
+ * @param timeline  The timeline to free
+ */
+void timeline_destroy(struct edgeTimeline* timeline);
+
+/**This function sorts a subarray of a servoArrays with the sorting network for its length, or with sort_insert if
+there isn't one. Unlike sort_insert, servos with the same timerLen may not stay in the same order.
+ * @param array[]   The array of servos
+ * @param arrayLen  The length of the array of servos
+ *
+ * @return          The sorted array of servos
+ */
+struct servo* sort_network(struct servo array[], int arraylen);
+
+/**This function sorts an array of servo keys with the sorting network for its length, or with sort_keys if there
+isn't one
+ * @param keys      The keys
+ * @param keysLen   The number of keys
+ */
+void sort_keys_network(uint64_t keys[], int keysLen);
+
+/**This function sorts all of the subArrays of a servoArrays like sort_arrays, picking the sorting network for their
+length once rather than for each subArray
+ * @param arrayOfArrays The servoArrays to be sorted
+ */
+void sort_arrays_network(struct servoArrays arrayOfArrays);
+
+/**This function sorts every group of a servoBank like sort_bank, with the sorting network for the group length
+ * @param bank      The bank to be sorted
+ */
+void sort_bank_network(struct servoBank bank);
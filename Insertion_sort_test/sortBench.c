@@ -0,0 +1,598 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "servos.h"
+
+/* Benchmarks of the servo sorts, on banks of random servos from 9 groups of 6 up to 10^5 groups of 64.
+ * The first table times sort_arrays against sort_arrays_parallel and shows how many times faster the parallel one
+ * is, so you can see the bank size where the threads start to pay. The second compares the servoArrays layout, with
+ * each group allocated on its own as main.c does, against the one block servoBank, by memory used and by the time
+ * sort_arrays and sort_bank take. The third times merge_edges making the edge timeline of banks of 10^3 to 10^5
+ * servos with realistic on times, against gathering every edge and sorting them with qsort, and counts the edges
+ * closer than an ISR time apart. The fourth times the sorting networks against insertion sort on 2 million groups of
+ * each size, with random times and with each group sorted but for one pair next to each other swapped, in both
+ * layouts. Times are medians, every bank is put back in its unsorted order before each sort, and each sort and merge
+ * is checked.
+ *
+ * Usage: SortBench [-threads n] [-trials n] [-o results.csv] [-layout layout.csv] [-merge merge.csv]
+ *                  [-network network.csv]
+ */
+
+// Define constants
+#define DEFAULT_TRIALS 7
+#define MIN_TRIAL_TIME 0.01         // Seconds, small banks are sorted over and over until a trial takes this long.
+#define MIN_ON_TIME 500.0           // us, the on times of the servos in the merge table, as ServoList's defaults.
+#define MAX_ON_TIME 2500.0
+#define SLOT_LENGTH (MIN_ON_TIME + MAX_ON_TIME)
+#define GUARD_TIME 100.0            // us, as ServoList's ITRPTTIME.
+#define NETWORK_GROUPS 2000000
+
+static const int groupCounts[] = {9, 100, 1000, 10000, 100000};
+static const int groupLengths[] = {6, 16, 64};
+static const int servoCounts[] = {1000, 10000, 100000};
+static const int networkLengths[] = {3, 6, 8, 12, 16, 20};
+
+#define NO_OF_COUNTS ((int)(sizeof(groupCounts) / sizeof(groupCounts[0])))
+#define NO_OF_LENGTHS ((int)(sizeof(groupLengths) / sizeof(groupLengths[0])))
+#define NO_OF_SERVO_COUNTS ((int)(sizeof(servoCounts) / sizeof(servoCounts[0])))
+#define NO_OF_NETWORK_LENGTHS ((int)(sizeof(networkLengths) / sizeof(networkLengths[0])))
+
+/* Everything one timed sort needs: the bank in each layout, its unsorted copies and the pool */
+struct benchBank{
+    struct servoArrays arrays;
+    struct servo* unsorted;
+    struct servoBank bank;
+    uint64_t* unsortedKeys;
+    struct sortPool* pool;
+    struct edgeTimeline timeline;       // The last merge_edges result.
+    struct edgeTimeline reference;      // The last qsort result.
+};
+
+// Hidden function declarations
+void parallel_table(struct sortPool* pool, int trials, FILE* csv);
+void layout_table(int trials, FILE* csv);
+void merge_table(int trials, FILE* csv);
+void network_table(int trials, FILE* csv);
+double time_sort(void (*restore)(struct benchBank*), void (*sort)(struct benchBank*), struct benchBank* bench,
+                 int trials);
+void restore_arrays(struct benchBank* bench);
+void restore_bank(struct benchBank* bench);
+void run_sort_arrays(struct benchBank* bench);
+void run_sort_arrays_parallel(struct benchBank* bench);
+void run_sort_bank(struct benchBank* bench);
+void run_sort_arrays_network(struct benchBank* bench);
+void run_sort_bank_network(struct benchBank* bench);
+void restore_nothing(struct benchBank* bench);
+void run_merge_edges(struct benchBank* bench);
+void run_qsort_edges(struct benchBank* bench);
+int compare_edges(const void* a, const void* b);
+void fill_random(struct servo* servos, size_t total, int arraysLen);
+void fill_nearly_sorted(struct servo* servos, size_t total, int arraysLen);
+int is_arrays_sorted(struct servoArrays arrayOfArrays);
+int is_bank_sorted(struct servoBank bank);
+double monotonic_seconds(void);
+int compare_doubles(const void* a, const void* b);
+
+int main(int argc, char* argv[]){
+    int noOfThreads = 0;
+    int trials = DEFAULT_TRIALS;
+    const char* csvName = NULL;
+    const char* layoutName = NULL;
+    const char* mergeName = NULL;
+    const char* networkName = NULL;
+    FILE* csv = NULL;
+    FILE* layoutCsv = NULL;
+    FILE* mergeCsv = NULL;
+    FILE* networkCsv = NULL;
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(strcmp(argv[i], "-threads") == 0) noOfThreads = atoi(argv[i + 1]);
+        else if(strcmp(argv[i], "-trials") == 0) trials = atoi(argv[i + 1]);
+        else if(strcmp(argv[i], "-o") == 0) csvName = argv[i + 1];
+        else if(strcmp(argv[i], "-layout") == 0) layoutName = argv[i + 1];
+        else if(strcmp(argv[i], "-merge") == 0) mergeName = argv[i + 1];
+        else if(strcmp(argv[i], "-network") == 0) networkName = argv[i + 1];
+        else{
+            printf("Usage: %s [-threads n] [-trials n] [-o results.csv] [-layout layout.csv] [-merge merge.csv] "
+                   "[-network network.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if(trials < 1){
+        trials = 1;
+    }
+    struct sortPool* pool = sort_pool_create(noOfThreads);
+    if(pool == NULL){
+        printf("Could not start the threads\n");
+        return 1;
+    }
+    if(csvName != NULL && (csv = fopen(csvName, "w")) == NULL){
+        printf("Could not open %s\n", csvName);
+        sort_pool_destroy(pool);
+        return 1;
+    }
+    if(layoutName != NULL && (layoutCsv = fopen(layoutName, "w")) == NULL){
+        printf("Could not open %s\n", layoutName);
+    }
+    else if(mergeName != NULL && (mergeCsv = fopen(mergeName, "w")) == NULL){
+        printf("Could not open %s\n", mergeName);
+    }
+    else if(networkName != NULL && (networkCsv = fopen(networkName, "w")) == NULL){
+        printf("Could not open %s\n", networkName);
+    }
+    else{
+        parallel_table(pool, trials, csv);
+        printf("\n");
+        layout_table(trials, layoutCsv);
+        printf("\n");
+        merge_table(trials, mergeCsv);
+        printf("\n");
+        network_table(trials, networkCsv);
+    }
+
+    if(csv != NULL){
+        fclose(csv);
+    }
+    if(layoutCsv != NULL){
+        fclose(layoutCsv);
+    }
+    if(mergeCsv != NULL){
+        fclose(mergeCsv);
+    }
+    if(networkCsv != NULL){
+        fclose(networkCsv);
+    }
+    sort_pool_destroy(pool);
+    return 0;
+}
+
+
+// Hidden functions
+
+/**This function prints the table of sort_arrays against sort_arrays_parallel
+ * @param pool      The pool for the parallel sort
+ * @param trials    How many trials to take the median of
+ * @param csv       A file to write the table to as well, or NULL
+ */
+void parallel_table(struct sortPool* pool, int trials, FILE* csv){
+    if(csv != NULL){
+        fprintf(csv, "groups,group_len,serial_s,parallel_s,speedup,verified\n");
+    }
+    printf("%8s %9s %12s %12s %8s %9s\n", "groups", "group_len", "serial_s", "parallel_s", "speedup", "verified");
+    for(int c = 0; c < NO_OF_COUNTS; c++){
+        for(int l = 0; l < NO_OF_LENGTHS; l++){
+            struct benchBank bench;
+            bench.arrays.noOfArrays = groupCounts[c];
+            bench.arrays.arraysLen = groupLengths[l];
+            bench.pool = pool;
+            size_t total = (size_t)bench.arrays.noOfArrays * bench.arrays.arraysLen;
+            struct servo* storage = malloc(sizeof(struct servo) * total);
+            bench.unsorted = malloc(sizeof(struct servo) * total);
+            bench.arrays.servos = malloc(sizeof(struct servo*) * bench.arrays.noOfArrays);
+            if(storage == NULL || bench.unsorted == NULL || bench.arrays.servos == NULL){
+                printf("Out of memory at %d groups of %d\n", bench.arrays.noOfArrays, bench.arrays.arraysLen);
+                free(storage);
+                free(bench.unsorted);
+                free(bench.arrays.servos);
+                continue;
+            }
+            for(int i = 0; i < bench.arrays.noOfArrays; i++){
+                bench.arrays.servos[i] = storage + (size_t)i * bench.arrays.arraysLen;
+            }
+            fill_random(bench.unsorted, total, bench.arrays.arraysLen);
+
+            double serial = time_sort(restore_arrays, run_sort_arrays, &bench, trials);
+            int verified = is_arrays_sorted(bench.arrays);
+            double parallel = time_sort(restore_arrays, run_sort_arrays_parallel, &bench, trials);
+            verified = verified && is_arrays_sorted(bench.arrays);
+
+            printf("%8d %9d %12.9f %12.9f %8.2f %9d\n", bench.arrays.noOfArrays, bench.arrays.arraysLen, serial,
+                   parallel, serial / parallel, verified);
+            if(csv != NULL){
+                fprintf(csv, "%d,%d,%.9f,%.9f,%.3f,%d\n", bench.arrays.noOfArrays, bench.arrays.arraysLen, serial,
+                        parallel, serial / parallel, verified);
+                fflush(csv);
+            }
+            free(storage);
+            free(bench.unsorted);
+            free(bench.arrays.servos);
+        }
+    }
+}
+
+/**This function prints the table of the servoArrays layout against the servoBank one
+ * @param trials    How many trials to take the median of
+ * @param csv       A file to write the table to as well, or NULL
+ */
+void layout_table(int trials, FILE* csv){
+    if(csv != NULL){
+        fprintf(csv, "groups,group_len,arrays_bytes,arrays_blocks,bank_bytes,bank_blocks,sort_arrays_s,sort_bank_s,"
+                "speedup,verified\n");
+    }
+    printf("%8s %9s %13s %13s %13s %12s %8s %9s\n", "groups", "group_len", "arrays_bytes", "bank_bytes",
+           "sort_arrays_s", "sort_bank_s", "speedup", "verified");
+    for(int c = 0; c < NO_OF_COUNTS; c++){
+        for(int l = 0; l < NO_OF_LENGTHS; l++){
+            struct benchBank bench;
+            int allocated = 0;
+            bench.arrays.noOfArrays = groupCounts[c];
+            bench.arrays.arraysLen = groupLengths[l];
+            bench.pool = NULL;
+            size_t total = (size_t)bench.arrays.noOfArrays * bench.arrays.arraysLen;
+            bench.unsorted = malloc(sizeof(struct servo) * total);
+            bench.arrays.servos = malloc(sizeof(struct servo*) * bench.arrays.noOfArrays);
+            if(bench.unsorted != NULL && bench.arrays.servos != NULL){
+                // One block per group, the way main.c builds a servoArrays.
+                for(; allocated < bench.arrays.noOfArrays; allocated++){
+                    bench.arrays.servos[allocated] = malloc(sizeof(struct servo) * bench.arrays.arraysLen);
+                    if(bench.arrays.servos[allocated] == NULL){
+                        break;
+                    }
+                }
+            }
+            bench.bank.entries = NULL;
+            bench.bank.block = NULL;
+            bench.unsortedKeys = NULL;
+            if(allocated == bench.arrays.noOfArrays){
+                fill_random(bench.unsorted, total, bench.arrays.arraysLen);
+                restore_arrays(&bench);
+                bench.bank = bank_from_arrays(bench.arrays, 1000);
+                bench.unsortedKeys = malloc(bank_bytes(bench.bank));
+            }
+            if(bench.bank.entries == NULL || bench.unsortedKeys == NULL){
+                printf("Out of memory at %d groups of %d\n", bench.arrays.noOfArrays, bench.arrays.arraysLen);
+            }
+            else{
+                memcpy(bench.unsortedKeys, bench.bank.entries,
+                       sizeof(uint64_t) * bench.bank.noOfArrays * bench.bank.stride);
+                double rows = time_sort(restore_arrays, run_sort_arrays, &bench, trials);
+                int verified = is_arrays_sorted(bench.arrays);
+                double bank = time_sort(restore_bank, run_sort_bank, &bench, trials);
+                verified = verified && is_bank_sorted(bench.bank);
+
+                printf("%8d %9d %13zu %13zu %13.9f %12.9f %8.2f %9d\n", bench.arrays.noOfArrays,
+                       bench.arrays.arraysLen, arrays_bytes(bench.arrays), bank_bytes(bench.bank), rows, bank,
+                       rows / bank, verified);
+                if(csv != NULL){
+                    fprintf(csv, "%d,%d,%zu,%d,%zu,1,%.9f,%.9f,%.3f,%d\n", bench.arrays.noOfArrays,
+                            bench.arrays.arraysLen, arrays_bytes(bench.arrays), bench.arrays.noOfArrays + 1,
+                            bank_bytes(bench.bank), rows, bank, rows / bank, verified);
+                    fflush(csv);
+                }
+            }
+            for(int i = 0; i < allocated; i++){
+                free(bench.arrays.servos[i]);
+            }
+            bank_destroy(&bench.bank);
+            free(bench.unsortedKeys);
+            free(bench.unsorted);
+            free(bench.arrays.servos);
+        }
+    }
+}
+
+/**This function prints the table of merge_edges against sorting every edge with qsort
+ * @param trials    How many trials to take the median of
+ * @param csv       A file to write the table to as well, or NULL
+ */
+void merge_table(int trials, FILE* csv){
+    if(csv != NULL){
+        fprintf(csv, "servos,group_len,groups,merge_s,qsort_s,speedup,clashes,verified\n");
+    }
+    printf("%8s %9s %8s %12s %12s %8s %8s %9s\n", "servos", "group_len", "groups", "merge_s", "qsort_s", "speedup",
+           "clashes", "verified");
+    for(int c = 0; c < NO_OF_SERVO_COUNTS; c++){
+        for(int l = 0; l < NO_OF_LENGTHS; l++){
+            struct benchBank bench;
+            bench.arrays.arraysLen = groupLengths[l];
+            bench.arrays.noOfArrays = servoCounts[c] / groupLengths[l];
+            size_t total = (size_t)bench.arrays.noOfArrays * bench.arrays.arraysLen;
+            struct servo* storage = malloc(sizeof(struct servo) * total);
+            bench.arrays.servos = malloc(sizeof(struct servo*) * bench.arrays.noOfArrays);
+            bench.timeline.edges = NULL;
+            bench.reference.edges = NULL;
+            if(storage == NULL || bench.arrays.servos == NULL){
+                printf("Out of memory at %zu servos\n", total);
+                free(storage);
+                free(bench.arrays.servos);
+                continue;
+            }
+            for(size_t i = 0; i < total; i++){
+                storage[i].pinNo = (int)i;
+                storage[i].timerLen = MIN_ON_TIME + (MAX_ON_TIME - MIN_ON_TIME) * rand() / RAND_MAX;
+            }
+            for(int i = 0; i < bench.arrays.noOfArrays; i++){
+                bench.arrays.servos[i] = storage + (size_t)i * bench.arrays.arraysLen;
+            }
+            sort_arrays(bench.arrays);
+
+            double merge = time_sort(restore_nothing, run_merge_edges, &bench, trials);
+            double sorted = time_sort(restore_nothing, run_qsort_edges, &bench, trials);
+            int verified = bench.timeline.edges != NULL && bench.reference.edges != NULL &&
+                           bench.timeline.noOfEdges == (int)total && bench.reference.noOfEdges == (int)total &&
+                           bench.timeline.noOfClashes == bench.reference.noOfClashes;
+            for(size_t i = 0; verified && i < total; i++){
+                verified = bench.timeline.edges[i].time == bench.reference.edges[i].time;
+            }
+
+            printf("%8zu %9d %8d %12.9f %12.9f %8.2f %8d %9d\n", total, bench.arrays.arraysLen,
+                   bench.arrays.noOfArrays, merge, sorted, sorted / merge, bench.timeline.noOfClashes, verified);
+            if(csv != NULL){
+                fprintf(csv, "%zu,%d,%d,%.9f,%.9f,%.3f,%d,%d\n", total, bench.arrays.arraysLen,
+                        bench.arrays.noOfArrays, merge, sorted, sorted / merge, bench.timeline.noOfClashes, verified);
+                fflush(csv);
+            }
+            timeline_destroy(&bench.timeline);
+            timeline_destroy(&bench.reference);
+            free(storage);
+            free(bench.arrays.servos);
+        }
+    }
+}
+
+/**This function prints the table of the sorting networks against insertion sort, for both layouts
+ * @param trials    How many trials to take the median of
+ * @param csv       A file to write the table to as well, or NULL
+ */
+void network_table(int trials, FILE* csv){
+    static const char* orders[] = {"random", "nearly"};
+
+    if(csv != NULL){
+        fprintf(csv, "group_len,times,sort_insert_s,sort_network_s,speedup,sort_keys_s,sort_keys_network_s,"
+                "keys_speedup,verified\n");
+    }
+    printf("%9s %7s %13s %14s %8s %12s %13s %8s %9s\n", "group_len", "times", "sort_insert_s", "sort_network_s",
+           "speedup", "sort_keys_s", "keys_network", "speedup", "verified");
+    for(int l = 0; l < NO_OF_NETWORK_LENGTHS; l++){
+        for(int order = 0; order < 2; order++){
+            struct benchBank bench;
+            bench.arrays.noOfArrays = NETWORK_GROUPS;
+            bench.arrays.arraysLen = networkLengths[l];
+            size_t total = (size_t)bench.arrays.noOfArrays * bench.arrays.arraysLen;
+            struct servo* storage = malloc(sizeof(struct servo) * total);
+            bench.unsorted = malloc(sizeof(struct servo) * total);
+            bench.arrays.servos = malloc(sizeof(struct servo*) * bench.arrays.noOfArrays);
+            bench.bank.entries = NULL;
+            bench.bank.block = NULL;
+            bench.unsortedKeys = NULL;
+            if(storage != NULL && bench.unsorted != NULL && bench.arrays.servos != NULL){
+                for(int i = 0; i < bench.arrays.noOfArrays; i++){
+                    bench.arrays.servos[i] = storage + (size_t)i * bench.arrays.arraysLen;
+                }
+                if(order == 0){
+                    fill_random(bench.unsorted, total, bench.arrays.arraysLen);
+                }
+                else{
+                    fill_nearly_sorted(bench.unsorted, total, bench.arrays.arraysLen);
+                }
+                restore_arrays(&bench);
+                bench.bank = bank_from_arrays(bench.arrays, 1000);
+                bench.unsortedKeys = malloc(bank_bytes(bench.bank));
+            }
+            if(bench.bank.entries == NULL || bench.unsortedKeys == NULL){
+                printf("Out of memory at %d groups of %d\n", bench.arrays.noOfArrays, bench.arrays.arraysLen);
+            }
+            else{
+                memcpy(bench.unsortedKeys, bench.bank.entries,
+                       sizeof(uint64_t) * bench.bank.noOfArrays * bench.bank.stride);
+                double insert = time_sort(restore_arrays, run_sort_arrays, &bench, trials);
+                double network = time_sort(restore_arrays, run_sort_arrays_network, &bench, trials);
+                int verified = is_arrays_sorted(bench.arrays);
+                double keys = time_sort(restore_bank, run_sort_bank, &bench, trials);
+                double keysNetwork = time_sort(restore_bank, run_sort_bank_network, &bench, trials);
+                verified = verified && is_bank_sorted(bench.bank);
+
+                printf("%9d %7s %13.9f %14.9f %8.2f %12.9f %13.9f %8.2f %9d\n", bench.arrays.arraysLen,
+                       orders[order], insert, network, insert / network, keys, keysNetwork, keys / keysNetwork,
+                       verified);
+                if(csv != NULL){
+                    fprintf(csv, "%d,%s,%.9f,%.9f,%.3f,%.9f,%.9f,%.3f,%d\n", bench.arrays.arraysLen, orders[order],
+                            insert, network, insert / network, keys, keysNetwork, keys / keysNetwork, verified);
+                    fflush(csv);
+                }
+            }
+            bank_destroy(&bench.bank);
+            free(bench.unsortedKeys);
+            free(storage);
+            free(bench.unsorted);
+            free(bench.arrays.servos);
+        }
+    }
+}
+
+/**This function times a sort, putting the bank back in its unsorted order before each go
+ * @param restore   Puts the bank back in its unsorted order
+ * @param sort      The sort to time
+ * @param bench     The bank
+ * @param trials    How many trials to take the median of
+ *
+ * @return          The median time for one sort of the bank, in seconds
+ */
+double time_sort(void (*restore)(struct benchBank*), void (*sort)(struct benchBank*), struct benchBank* bench,
+                 int trials){
+    double* times = malloc(sizeof(double) * trials);
+    int repeats = 1;
+    double median;
+
+    for(int trial = 0; trial < trials; trial++){
+        double sorting = 0;
+        for(int r = 0; r < repeats; r++){
+            restore(bench);
+            double start = monotonic_seconds();
+            sort(bench);
+            sorting += monotonic_seconds() - start;
+        }
+        times[trial] = sorting / repeats;
+        if(trial == 0 && sorting < MIN_TRIAL_TIME){
+            // The first trial was too short to time well, so it is a warm up and the rest repeat the sort.
+            repeats = (int)(MIN_TRIAL_TIME / (sorting / repeats + 1e-9)) + 1;
+        }
+    }
+    qsort(times, trials, sizeof(double), compare_doubles);
+    median = times[trials / 2];
+    free(times);
+    return median;
+}
+
+// These put a bank back in its unsorted order and run each sort on it, for time_sort
+void restore_arrays(struct benchBank* bench){
+    for(int i = 0; i < bench->arrays.noOfArrays; i++){
+        memcpy(bench->arrays.servos[i], bench->unsorted + (size_t)i * bench->arrays.arraysLen,
+               sizeof(struct servo) * bench->arrays.arraysLen);
+    }
+}
+
+void restore_bank(struct benchBank* bench){
+    memcpy(bench->bank.entries, bench->unsortedKeys, sizeof(uint64_t) * bench->bank.noOfArrays * bench->bank.stride);
+}
+
+void run_sort_arrays(struct benchBank* bench){
+    sort_arrays(bench->arrays);
+}
+
+void run_sort_arrays_parallel(struct benchBank* bench){
+    sort_arrays_parallel(bench->arrays, bench->pool);
+}
+
+void run_sort_bank(struct benchBank* bench){
+    sort_bank(bench->bank);
+}
+
+void run_sort_arrays_network(struct benchBank* bench){
+    sort_arrays_network(bench->arrays);
+}
+
+void run_sort_bank_network(struct benchBank* bench){
+    sort_bank_network(bench->bank);
+}
+
+// merge_edges and the qsort it is checked against don't change the bank, so there is nothing to put back
+void restore_nothing(struct benchBank* bench){
+    (void)bench;
+}
+
+void run_merge_edges(struct benchBank* bench){
+    timeline_destroy(&bench->timeline);
+    merge_edges(bench->arrays, SLOT_LENGTH, GUARD_TIME, &bench->timeline);
+}
+
+// Makes the same timeline as merge_edges by gathering every edge and sorting them all with qsort
+void run_qsort_edges(struct benchBank* bench){
+    struct edgeTimeline* reference = &bench->reference;
+    int total = bench->arrays.noOfArrays * bench->arrays.arraysLen;
+
+    timeline_destroy(reference);
+    reference->edges = malloc(sizeof(struct servoEdge) * (total + 1));
+    if(reference->edges == NULL){
+        return;
+    }
+    for(int i = 0; i < bench->arrays.noOfArrays; i++){
+        for(int j = 0; j < bench->arrays.arraysLen; j++){
+            struct servoEdge* edge = &reference->edges[i * bench->arrays.arraysLen + j];
+            edge->time = i * SLOT_LENGTH + bench->arrays.servos[i][j].timerLen;
+            edge->pinNo = bench->arrays.servos[i][j].pinNo;
+            edge->group = i;
+        }
+    }
+    qsort(reference->edges, total, sizeof(struct servoEdge), compare_edges);
+    for(int i = 0; i < total; i++){
+        reference->edges[i].tooClose = i > 0 && reference->edges[i].time - reference->edges[i - 1].time < GUARD_TIME;
+        reference->noOfClashes += reference->edges[i].tooClose;
+    }
+    reference->noOfEdges = total;
+}
+
+int compare_edges(const void* a, const void* b){
+    const struct servoEdge* x = a;
+    const struct servoEdge* y = b;
+    return (x->time > y->time) - (x->time < y->time);
+}
+
+/**This function fills servos with random timer lengths, the way main.c does, and pins numbered within each group
+ * @param servos    The servos
+ * @param total     How many servos
+ * @param arraysLen The number of servos in each group
+ */
+void fill_random(struct servo* servos, size_t total, int arraysLen){
+    for(size_t i = 0; i < total; i++){
+        servos[i].pinNo = (int)(i % arraysLen);
+        servos[i].timerLen = ((double)rand())/1000;
+    }
+}
+
+/**This function fills servos with groups that are each in order but for one random pair next to each other swapped
+ * @param servos    The servos
+ * @param total     How many servos
+ * @param arraysLen The number of servos in each group
+ */
+void fill_nearly_sorted(struct servo* servos, size_t total, int arraysLen){
+    fill_random(servos, total, arraysLen);
+    for(size_t first = 0; first + arraysLen <= total; first += arraysLen){
+        sort_insert(servos + first, arraysLen);
+        if(arraysLen > 1){
+            size_t place = first + rand() % (arraysLen - 1);
+            struct servo temp = servos[place];
+            servos[place] = servos[place + 1];
+            servos[place + 1] = temp;
+        }
+    }
+}
+
+/**This function checks every subArray of a servoArrays is in order
+ * @param arrayOfArrays The servoArrays to check
+ *
+ * @return              1 if it is sorted, 0 if not
+ */
+int is_arrays_sorted(struct servoArrays arrayOfArrays){
+    for(int i = 0; i < arrayOfArrays.noOfArrays; i++){
+        for(int j = 1; j < arrayOfArrays.arraysLen; j++){
+            if(arrayOfArrays.servos[i][j-1].timerLen > arrayOfArrays.servos[i][j].timerLen){
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**This function checks every group of a servoBank is in order of timer length
+ * @param bank      The bank to check
+ *
+ * @return          1 if it is sorted, 0 if not
+ */
+int is_bank_sorted(struct servoBank bank){
+    for(int i = 0; i < bank.noOfArrays; i++){
+        const uint64_t* group = bank.entries + (size_t)i * bank.stride;
+        for(int j = 1; j < bank.arraysLen; j++){
+            if(SERVO_KEY_TICKS(group[j-1]) > SERVO_KEY_TICKS(group[j])){
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**This function reads a clock that only ever goes forwards, in seconds
+ */
+double monotonic_seconds(void){
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+int compare_doubles(const void* a, const void* b){
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,160 @@
+/* Sorting networks for 2 to 16 items, with the fewest compare and exchange steps known for each size.
+ * SORT_NETWORK_n(SWAP) expands to the steps of the network for n items as SWAP(i, j), meaning put the smaller of
+ * items i and j in i and the larger in j, one line per layer of steps that touch different items. Define SWAP for
+ * the type being sorted; with a branchless SWAP the whole sort has no branches and its steps are fixed when it is
+ * compiled. Every network here was checked on all 2^n inputs of 0s and 1s, which is enough to show it sorts anything.
+ * Networks don't keep equal items in order, so they aren't stable.
+ */
+#ifndef SORT_NETWORKS_H
+#define SORT_NETWORKS_H
+
+#define SORT_NETWORK_MIN 2
+#define SORT_NETWORK_MAX 16
+
+// 2 items, 1 step in 1 layer
+#define SORT_NETWORK_2(SWAP) \
+    SWAP(0, 1)
+
+// 3 items, 3 steps in 3 layers
+#define SORT_NETWORK_3(SWAP) \
+    SWAP(0, 2) \
+    SWAP(0, 1) \
+    SWAP(1, 2)
+
+// 4 items, 5 steps in 3 layers
+#define SORT_NETWORK_4(SWAP) \
+    SWAP(0, 2) SWAP(1, 3) \
+    SWAP(0, 1) SWAP(2, 3) \
+    SWAP(1, 2)
+
+// 5 items, 9 steps in 5 layers
+#define SORT_NETWORK_5(SWAP) \
+    SWAP(0, 3) SWAP(1, 4) \
+    SWAP(0, 2) SWAP(1, 3) \
+    SWAP(0, 1) SWAP(2, 4) \
+    SWAP(1, 2) SWAP(3, 4) \
+    SWAP(2, 3)
+
+// 6 items, 12 steps in 5 layers
+#define SORT_NETWORK_6(SWAP) \
+    SWAP(0, 5) SWAP(1, 3) SWAP(2, 4) \
+    SWAP(1, 2) SWAP(3, 4) \
+    SWAP(0, 3) SWAP(2, 5) \
+    SWAP(0, 1) SWAP(2, 3) SWAP(4, 5) \
+    SWAP(1, 2) SWAP(3, 4)
+
+// 7 items, 16 steps in 6 layers
+#define SORT_NETWORK_7(SWAP) \
+    SWAP(0, 6) SWAP(2, 3) SWAP(4, 5) \
+    SWAP(0, 2) SWAP(1, 4) SWAP(3, 6) \
+    SWAP(0, 1) SWAP(2, 5) SWAP(3, 4) \
+    SWAP(1, 2) SWAP(4, 6) \
+    SWAP(2, 3) SWAP(4, 5) \
+    SWAP(1, 2) SWAP(3, 4) SWAP(5, 6)
+
+// 8 items, 19 steps in 6 layers
+#define SORT_NETWORK_8(SWAP) \
+    SWAP(0, 2) SWAP(1, 3) SWAP(4, 6) SWAP(5, 7) \
+    SWAP(0, 4) SWAP(1, 5) SWAP(2, 6) SWAP(3, 7) \
+    SWAP(0, 1) SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) \
+    SWAP(2, 4) SWAP(3, 5) \
+    SWAP(1, 4) SWAP(3, 6) \
+    SWAP(1, 2) SWAP(3, 4) SWAP(5, 6)
+
+// 9 items, 25 steps in 7 layers
+#define SORT_NETWORK_9(SWAP) \
+    SWAP(0, 3) SWAP(1, 7) SWAP(2, 5) SWAP(4, 8) \
+    SWAP(0, 7) SWAP(2, 4) SWAP(3, 8) SWAP(5, 6) \
+    SWAP(0, 2) SWAP(1, 3) SWAP(4, 5) SWAP(7, 8) \
+    SWAP(1, 4) SWAP(3, 6) SWAP(5, 7) \
+    SWAP(0, 1) SWAP(2, 4) SWAP(3, 5) SWAP(6, 8) \
+    SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) \
+    SWAP(1, 2) SWAP(3, 4) SWAP(5, 6)
+
+// 10 items, 29 steps in 8 layers
+#define SORT_NETWORK_10(SWAP) \
+    SWAP(0, 8) SWAP(1, 9) SWAP(2, 7) SWAP(3, 5) SWAP(4, 6) \
+    SWAP(0, 2) SWAP(1, 4) SWAP(5, 8) SWAP(7, 9) \
+    SWAP(0, 3) SWAP(2, 4) SWAP(5, 7) SWAP(6, 9) \
+    SWAP(0, 1) SWAP(3, 6) SWAP(8, 9) \
+    SWAP(1, 5) SWAP(2, 3) SWAP(4, 8) SWAP(6, 7) \
+    SWAP(1, 2) SWAP(3, 5) SWAP(4, 6) SWAP(7, 8) \
+    SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) \
+    SWAP(3, 4) SWAP(5, 6)
+
+// 11 items, 35 steps in 8 layers
+#define SORT_NETWORK_11(SWAP) \
+    SWAP(0, 9) SWAP(1, 6) SWAP(2, 4) SWAP(3, 7) SWAP(5, 8) \
+    SWAP(0, 1) SWAP(3, 5) SWAP(4, 10) SWAP(6, 9) SWAP(7, 8) \
+    SWAP(1, 3) SWAP(2, 5) SWAP(4, 7) SWAP(8, 10) \
+    SWAP(0, 4) SWAP(1, 2) SWAP(3, 7) SWAP(5, 9) SWAP(6, 8) \
+    SWAP(0, 1) SWAP(2, 6) SWAP(4, 5) SWAP(7, 8) SWAP(9, 10) \
+    SWAP(2, 4) SWAP(3, 6) SWAP(5, 7) SWAP(8, 9) \
+    SWAP(1, 2) SWAP(3, 4) SWAP(5, 6) SWAP(7, 8) \
+    SWAP(2, 3) SWAP(4, 5) SWAP(6, 7)
+
+// 12 items, 39 steps in 9 layers
+#define SORT_NETWORK_12(SWAP) \
+    SWAP(0, 8) SWAP(1, 7) SWAP(2, 6) SWAP(3, 11) SWAP(4, 10) SWAP(5, 9) \
+    SWAP(0, 1) SWAP(2, 5) SWAP(3, 4) SWAP(6, 9) SWAP(7, 8) SWAP(10, 11) \
+    SWAP(0, 2) SWAP(1, 6) SWAP(5, 10) SWAP(9, 11) \
+    SWAP(0, 3) SWAP(1, 2) SWAP(4, 6) SWAP(5, 7) SWAP(8, 11) SWAP(9, 10) \
+    SWAP(1, 4) SWAP(3, 5) SWAP(6, 8) SWAP(7, 10) \
+    SWAP(1, 3) SWAP(2, 5) SWAP(6, 9) SWAP(8, 10) \
+    SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) SWAP(8, 9) \
+    SWAP(4, 6) SWAP(5, 7) \
+    SWAP(3, 4) SWAP(5, 6) SWAP(7, 8)
+
+// 13 items, 45 steps in 10 layers
+#define SORT_NETWORK_13(SWAP) \
+    SWAP(0, 12) SWAP(1, 10) SWAP(2, 9) SWAP(3, 7) SWAP(5, 11) SWAP(6, 8) \
+    SWAP(1, 6) SWAP(2, 3) SWAP(4, 11) SWAP(7, 9) SWAP(8, 10) \
+    SWAP(0, 4) SWAP(1, 2) SWAP(3, 6) SWAP(7, 8) SWAP(9, 10) SWAP(11, 12) \
+    SWAP(4, 6) SWAP(5, 9) SWAP(8, 11) SWAP(10, 12) \
+    SWAP(0, 5) SWAP(3, 8) SWAP(4, 7) SWAP(6, 11) SWAP(9, 10) \
+    SWAP(0, 1) SWAP(2, 5) SWAP(6, 9) SWAP(7, 8) SWAP(10, 11) \
+    SWAP(1, 3) SWAP(2, 4) SWAP(5, 6) SWAP(9, 10) \
+    SWAP(1, 2) SWAP(3, 4) SWAP(5, 7) SWAP(6, 8) \
+    SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) SWAP(8, 9) \
+    SWAP(3, 4) SWAP(5, 6)
+
+// 14 items, 51 steps in 10 layers
+#define SORT_NETWORK_14(SWAP) \
+    SWAP(0, 1) SWAP(2, 3) SWAP(4, 5) SWAP(6, 7) SWAP(8, 9) SWAP(10, 11) SWAP(12, 13) \
+    SWAP(0, 2) SWAP(1, 3) SWAP(4, 8) SWAP(5, 9) SWAP(10, 12) SWAP(11, 13) \
+    SWAP(0, 4) SWAP(1, 2) SWAP(3, 7) SWAP(5, 8) SWAP(6, 10) SWAP(9, 13) SWAP(11, 12) \
+    SWAP(0, 6) SWAP(1, 5) SWAP(3, 9) SWAP(4, 10) SWAP(7, 13) SWAP(8, 12) \
+    SWAP(2, 10) SWAP(3, 11) SWAP(4, 6) SWAP(7, 9) \
+    SWAP(1, 3) SWAP(2, 8) SWAP(5, 11) SWAP(6, 7) SWAP(10, 12) \
+    SWAP(1, 4) SWAP(2, 6) SWAP(3, 5) SWAP(7, 11) SWAP(8, 10) SWAP(9, 12) \
+    SWAP(2, 4) SWAP(3, 6) SWAP(5, 8) SWAP(7, 10) SWAP(9, 11) \
+    SWAP(3, 4) SWAP(5, 6) SWAP(7, 8) SWAP(9, 10) \
+    SWAP(6, 7)
+
+// 15 items, 56 steps in 10 layers
+#define SORT_NETWORK_15(SWAP) \
+    SWAP(0, 13) SWAP(1, 12) SWAP(3, 14) SWAP(4, 8) SWAP(5, 6) SWAP(7, 11) SWAP(9, 10) \
+    SWAP(0, 5) SWAP(1, 7) SWAP(2, 9) SWAP(3, 4) SWAP(6, 13) SWAP(8, 14) SWAP(11, 12) \
+    SWAP(0, 1) SWAP(2, 3) SWAP(4, 5) SWAP(6, 8) SWAP(7, 9) SWAP(10, 11) SWAP(12, 13) \
+    SWAP(0, 2) SWAP(1, 3) SWAP(4, 10) SWAP(5, 11) SWAP(6, 7) SWAP(8, 9) SWAP(12, 14) \
+    SWAP(1, 2) SWAP(3, 12) SWAP(4, 6) SWAP(5, 7) SWAP(8, 10) SWAP(9, 11) SWAP(13, 14) \
+    SWAP(1, 4) SWAP(2, 6) SWAP(5, 8) SWAP(7, 10) SWAP(9, 13) SWAP(11, 14) \
+    SWAP(2, 4) SWAP(3, 6) SWAP(9, 12) SWAP(11, 13) \
+    SWAP(3, 5) SWAP(6, 8) SWAP(7, 9) SWAP(10, 12) \
+    SWAP(3, 4) SWAP(5, 6) SWAP(7, 8) SWAP(9, 10) SWAP(11, 12) \
+    SWAP(6, 7) SWAP(8, 9)
+
+// 16 items, 60 steps in 10 layers
+#define SORT_NETWORK_16(SWAP) \
+    SWAP(0, 13) SWAP(1, 12) SWAP(2, 15) SWAP(3, 14) SWAP(4, 8) SWAP(5, 6) SWAP(7, 11) SWAP(9, 10) \
+    SWAP(0, 5) SWAP(1, 7) SWAP(2, 9) SWAP(3, 4) SWAP(6, 13) SWAP(8, 14) SWAP(10, 15) SWAP(11, 12) \
+    SWAP(0, 1) SWAP(2, 3) SWAP(4, 5) SWAP(6, 8) SWAP(7, 9) SWAP(10, 11) SWAP(12, 13) SWAP(14, 15) \
+    SWAP(0, 2) SWAP(1, 3) SWAP(4, 10) SWAP(5, 11) SWAP(6, 7) SWAP(8, 9) SWAP(12, 14) SWAP(13, 15) \
+    SWAP(1, 2) SWAP(3, 12) SWAP(4, 6) SWAP(5, 7) SWAP(8, 10) SWAP(9, 11) SWAP(13, 14) \
+    SWAP(1, 4) SWAP(2, 6) SWAP(5, 8) SWAP(7, 10) SWAP(9, 13) SWAP(11, 14) \
+    SWAP(2, 4) SWAP(3, 6) SWAP(9, 12) SWAP(11, 13) \
+    SWAP(3, 5) SWAP(6, 8) SWAP(7, 9) SWAP(10, 12) \
+    SWAP(3, 4) SWAP(5, 6) SWAP(7, 8) SWAP(9, 10) SWAP(11, 12) \
+    SWAP(6, 7) SWAP(8, 9)
+
+#endif
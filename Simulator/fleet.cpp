@@ -0,0 +1,215 @@
+/* Parallel simulation of a fleet of robots, each with its own ServoList.
+ * Every robot runs against its own virtual clock on whichever worker of the thread pool picks it up.
+ * A robot's results only depend on the seed and its number, never on the threads, so a run can be repeated exactly.
+ *
+ * Usage: Fleet [-r robots] [-t seconds] [-s seed] [-j threads] [-o robots.csv]
+ *   -j  0 for one thread per core (default).
+ *   -o  Writes one CSV row per robot.
+ */
+#include "../servos.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const PinName FRAMEPIN = 1 << 30;
+
+/** Everything measured on one robot. */
+struct RobotResult
+{
+    int servos = 0;
+    int updateRate = 0;             // Updates per second.
+    uint64_t frames = 0;
+    uint64_t isrs = 0;
+    uint64_t pulses = 0;
+    uint64_t updates = 0;
+    double meanUtil = 0;            // ServoList::getUtilisation over every cycle, %.
+    double maxUtil = 0;
+    double isrDuty = 0;             // Time in ISRs from the simulator, %.
+    double meanError = 0;           // Pulse width error, us.
+    uint32_t maxError = 0;
+    uint64_t badWidths = 0;         // Pulses more than 10us out.
+};
+
+/** Mixes the fleet seed and the robot number into the robot's own seed. */
+static uint64_t robotSeed(uint64_t seed, uint64_t robot)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * (robot + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/** Simulates one robot from start to finish on the calling thread. */
+static RobotResult simulateRobot(uint64_t seed, int seconds)
+{
+    RobotResult result;
+    std::mt19937_64 random(seed);
+    std::vector<uint8_t> positions;
+    std::vector<uint64_t> riseTimes;
+    std::vector<int> expected;
+    double totalError = 0, totalUtil = 0;
+    int minOnTimeUs = 0, maxOnTimeUs = 0;     // Timings of the robot's list, read from it before it starts.
+    ServoList *list = NULL;
+
+    sim::reset();
+    sim::onPinChange = [&](uint64_t time, PinName pin, int value)
+    {
+        if (pin == FRAMEPIN)
+        {
+            if (value && result.frames++ > 0)
+            {
+                double util = list->getUtilisation();
+                totalUtil += util;
+                result.maxUtil = std::max(result.maxUtil, util);
+            }
+        } else if (value)
+        {
+            riseTimes[pin] = time;
+            expected[pin] = minOnTimeUs + ((maxOnTimeUs - minOnTimeUs) * positions[pin] / 256);
+            result.pulses++;
+        } else
+        {
+            uint32_t error = abs((int)(time - riseTimes[pin]) - expected[pin]);
+            totalError += error;
+            result.maxError = std::max(result.maxError, error);
+            result.badWidths += (error > 10);
+        }
+    };
+
+    {
+        ServoList servos;
+        list = &servos;
+        servos.setFramePin(FRAMEPIN);
+        minOnTimeUs = (int)servos.getMinOnTime().count();
+        maxOnTimeUs = (int)servos.getMaxOnTime().count();
+        positions.resize(servos.getMaxServos());
+        riseTimes.resize(servos.getMaxServos());
+        expected.resize(servos.getMaxServos());
+        result.servos = 1 + random() % servos.getMaxServos();
+        result.updateRate = 10 + random() % 1000;
+        for (int i = 0; i < result.servos; i++)
+        {
+            positions[i] = random() % 256;
+            servos.add((PinName)i, positions[i], i);
+        }
+
+        uint64_t endTime = (uint64_t)seconds * 1000000;
+        servos.start();
+        while (sim::now() < endTime)
+        {
+            sim::runUntil(sim::now() + random() % (2000000 / result.updateRate + 1));
+            int servo = random() % result.servos;
+            positions[servo] = random() % 256;
+            servos.updatePosition(servo, positions[servo]);
+            result.updates++;
+        }
+        servos.end();
+        sim::runUntil(sim::now() + 20000);      // Let the last cycle finish.
+    }
+
+    result.isrs = sim::isrCount();
+    result.isrDuty = 100.0 * sim::isrTime() / sim::now();
+    result.meanUtil = (result.frames > 1) ? totalUtil / (result.frames - 1) : 0;
+    result.meanError = (result.pulses > 0) ? totalError / result.pulses : 0;
+    sim::reset();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    int robots = 48;
+    int seconds = 60;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+    const char *csvFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            robots = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            csvFile = argv[++i];
+        } else
+        {
+            printf("Usage: %s [-r robots] [-t seconds] [-s seed] [-j threads] [-o robots.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<RobotResult> results(robots);
+    ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    pool.run(robots, [&](size_t robot) { results[robot] = simulateRobot(robotSeed(seed, robot), seconds); });
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Add up in robot order so the totals don't depend on which thread finished first.
+    uint64_t frames = 0, isrs = 0, pulses = 0, updates = 0, servos = 0, badWidths = 0;
+    double utilSum = 0, utilMax = 0, dutySum = 0, dutyMax = 0, errorSum = 0;
+    uint32_t errorMax = 0;
+    std::vector<double> duties;
+    for (const RobotResult &result : results)
+    {
+        frames += result.frames;
+        isrs += result.isrs;
+        pulses += result.pulses;
+        updates += result.updates;
+        servos += result.servos;
+        badWidths += result.badWidths;
+        utilSum += result.meanUtil;
+        utilMax = std::max(utilMax, result.maxUtil);
+        dutySum += result.isrDuty;
+        dutyMax = std::max(dutyMax, result.isrDuty);
+        errorSum += result.meanError * result.pulses;
+        errorMax = std::max(errorMax, result.maxError);
+        duties.push_back(result.isrDuty);
+    }
+    std::sort(duties.begin(), duties.end());
+    double dutyP99 = duties.empty() ? 0 : duties[(size_t)(0.99 * (duties.size() - 1) + 0.5)];
+
+    printf("fleet of %d robots, %d s each, seed %llu\n", robots, seconds, (unsigned long long)seed);
+    printf("servos %llu, frames %llu, ISRs %llu, pulses %llu, updates %llu\n",
+           (unsigned long long)servos, (unsigned long long)frames, (unsigned long long)isrs,
+           (unsigned long long)pulses, (unsigned long long)updates);
+    printf("utilisation: mean %.2f%%, max %.2f%%\n", robots ? utilSum / robots : 0.0, utilMax);
+    printf("ISR duty:    mean %.2f%%, p99 %.2f%%, max %.2f%%\n", robots ? dutySum / robots : 0.0, dutyP99, dutyMax);
+    printf("pulse error: mean %.3f us, max %u us, %llu over 10us\n",
+           pulses ? errorSum / pulses : 0.0, errorMax, (unsigned long long)badWidths);
+    printf("%zu threads, %.2f s wall, %.0f simulated seconds per second\n",
+           pool.size(), wall, (double)robots * seconds / wall);
+
+    if (csvFile)
+    {
+        FILE *csv = fopen(csvFile, "w");
+        if (!csv)
+        {
+            printf("Could not open %s\n", csvFile);
+            return 1;
+        }
+        fprintf(csv, "robot,servos,update_rate,frames,isrs,pulses,updates,mean_util,max_util,isr_duty,mean_error_us,max_error_us,bad_widths\n");
+        for (int i = 0; i < robots; i++)
+        {
+            const RobotResult &r = results[i];
+            fprintf(csv, "%d,%d,%d,%llu,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%u,%llu\n", i, r.servos, r.updateRate,
+                    (unsigned long long)r.frames, (unsigned long long)r.isrs, (unsigned long long)r.pulses,
+                    (unsigned long long)r.updates, r.meanUtil, r.maxUtil, r.isrDuty, r.meanError, r.maxError,
+                    (unsigned long long)r.badWidths);
+        }
+        fclose(csv);
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* Host simulation of the ServoList and Servos_ classes.
+ * Runs a bank of servos against the virtual clock in mbed.h and reports how busy the core was.
+ *
+ * Usage: Simulator [-n servos] [-t seconds] [-v file.vcd] [-1]
+ *   -n  Number of servos added to the ServoList. Default 30.
+ *   -t  Length of the simulation in seconds. Default 10.
+ *   -v  Write every pin change and ISR to a VCD file for a waveform viewer.
+ *   -1  Simulate one Servos_ on its own instead of the ServoList.
+ */
+#include "../servos.h"
+#include "../servo.h"
+#include "vcd.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+int main(int argc, char *argv[])
+{
+    int numServos = 30;
+    int seconds = 10;
+    const char *vcdFile = NULL;
+    bool single = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            numServos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+        {
+            vcdFile = argv[++i];
+        } else if (strcmp(argv[i], "-1") == 0)
+        {
+            single = true;
+        } else
+        {
+            printf("Usage: %s [-n servos] [-t seconds] [-v file.vcd] [-1]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint64_t endTime = (uint64_t)seconds * 1000000;
+    PinName framePin = (PinName)numServos;     // First pin after the servos.
+
+    std::unique_ptr<VcdWriter> vcd;
+    if (vcdFile)
+    {
+        vcd.reset(new VcdWriter(vcdFile));
+        if (!vcd->isOpen())
+        {
+            printf("Could not open %s\n", vcdFile);
+            return 1;
+        }
+        char name[16];
+        for (int i = 0; i < (single ? 1 : numServos); i++)
+        {
+            snprintf(name, sizeof(name), "servo%d", i);
+            vcd->addPin((PinName)i, name);
+        }
+        if (!single)
+        {
+            vcd->addEvent(framePin, "frame");
+        }
+        vcd->start();
+    }
+
+    if (single)
+    {
+        Servos_ servo(60, (PinName)0);
+        servo.run();
+        while (sim::now() < endTime)
+        {
+            sleep();
+        }
+        double simTime = (double)sim::now();
+        printf("Simulated %.3f s of one Servos_, %llu ISRs\n", simTime / 1e6, (unsigned long long)sim::isrCount());
+        printf("Duty cycle: %.2f%% in ISRs, %.2f%% asleep\n",
+               100.0 * sim::isrTime() / simTime, 100.0 * sim::sleepTime() / simTime);
+        return 0;
+    }
+
+    ServoList servos;
+    srand(1);
+    for (int i = 0; i < numServos; i++)
+    {
+        if (!servos.add((PinName)i, rand() % 256, i))
+        {
+            printf("List full at %d servos.\n", i);
+            break;
+        }
+    }
+    servos.setFramePin(framePin);
+
+    servos.start();
+
+    // The application's main loop, all it does is sleep until the servos need the core again.
+    int frames = 0;
+    float minUtil = 100, maxUtil = 0, totalUtil = 0;
+    uint64_t nextFrame = 20000;
+    while (sim::now() < endTime)
+    {
+        servos.sleepUntilNextEdge();
+        if (sim::now() >= nextFrame)
+        {
+            float util = servos.getUtilisation();
+            minUtil = (util < minUtil) ? util : minUtil;
+            maxUtil = (util > maxUtil) ? util : maxUtil;
+            totalUtil += util;
+            frames++;
+            nextFrame += 20000;
+        }
+    }
+    servos.end();
+
+    double simTime = (double)sim::now();
+    printf("Simulated %.3f s, %d frames, %llu ISRs\n", simTime / 1e6, frames, (unsigned long long)sim::isrCount());
+    printf("Utilisation per frame: min %.2f%% mean %.2f%% max %.2f%%\n",
+           minUtil, (frames > 0) ? totalUtil / frames : 0.0f, maxUtil);
+    printf("Duty cycle: %.2f%% in ISRs, %.2f%% asleep\n",
+           100.0 * sim::isrTime() / simTime, 100.0 * sim::sleepTime() / simTime);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/* Host stand-in for the parts of mbed.h used by the servo code.
+ * Nothing here touches real hardware, every timer runs against one virtual microsecond clock
+ * so a whole run of the servo code can be stepped through on a PC.
+ */
+#ifndef SIM_MBED_H
+#define SIM_MBED_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+typedef int PinName;
+enum { D0, D1, D2, D3, D4, D5, D6, D7, D8, D9, D10, D11, D12, D13, D14, D15 };
+
+namespace mbed
+{
+    template <typename F> class Callback;
+
+    /** Function object that the Timeouts call, same use as the mbed version. */
+    template <> class Callback<void()>
+    {
+    private:
+        std::function<void()> function_;
+
+    public:
+        Callback() {}
+        Callback(std::function<void()> function) : function_(function) {}
+        void operator () () const { function_(); }
+        explicit operator bool () const { return (bool)function_; }
+    };
+
+    /** Binds a member function to the object it is called on. */
+    template <typename T>
+    Callback<void()> callback(T *obj, void (T::*method)())
+    {
+        return Callback<void()>([obj, method]() { (obj->*method)(); });
+    }
+}
+using mbed::Callback;
+using mbed::callback;
+
+/** Digital output pin, every change of level is passed on to sim::onPinChange. */
+class DigitalOut
+{
+private:
+    PinName pin_;
+    int value_;
+
+public:
+    DigitalOut(PinName pin, int value = 0);
+    void write(int value);
+    int read(){ return value_; }
+    DigitalOut& operator = (int value){ write(value); return *this; }
+    operator int (){ return value_; }
+};
+
+/** One shot timer, attaching a new callback replaces the one that is waiting. */
+class Timeout
+{
+public:
+    struct Slot
+    {
+        Callback<void()> function;
+        uint32_t generation = 0;
+    };
+
+private:
+    std::shared_ptr<Slot> slot_;
+
+public:
+    Timeout();
+    ~Timeout();
+    void attach(Callback<void()> function, std::chrono::microseconds delay);
+    void detach();
+};
+
+/** Busy waits, in an ISR any other interrupts due in the meantime are held until it returns. */
+void wait_us(int us);
+
+/** Sleeps until the next interrupt is due and services it. */
+void sleep();
+
+void __disable_irq();
+void __enable_irq();
+
+/** Current value of the microsecond ticker, wraps like the real one. */
+uint32_t us_ticker_read();
+
+/** Controls and results for the simulation itself, not part of mbed.
+ * Each thread has its own clock and interrupts, so separate simulations can run on separate threads.
+ */
+namespace sim
+{
+    /** Virtual time since the simulation started, in us. */
+    uint64_t now();
+
+    /** Starts this thread's simulation again from time 0, throwing away any waiting interrupts and the hooks. */
+    void reset();
+
+    /** Sets how long it takes to get into an ISR once it is due. Default 2us. */
+    void setIsrLatency(std::chrono::microseconds latency);
+
+    /** Services every interrupt due before time, sleeping between them. */
+    void runUntil(uint64_t time);
+
+    /** Total time spent inside ISRs, in us. */
+    uint64_t isrTime();
+
+    /** Total time spent asleep, in us. */
+    uint64_t sleepTime();
+
+    /** Number of ISRs serviced. */
+    uint64_t isrCount();
+
+    /** Called on every pin change, time in us. Empty by default. */
+    extern thread_local std::function<void(uint64_t time, PinName pin, int value)> onPinChange;
+
+    /** Called as the core enters and leaves every ISR, time in us. Empty by default. */
+    extern thread_local std::function<void(uint64_t time, bool entering)> onIsr;
+}
+
+#endif
@@ -0,0 +1,212 @@
+#include "mbed.h"
+#include <queue>
+#include <vector>
+
+// Simulation state.
+
+namespace
+{
+    /** An interrupt waiting to happen. */
+    struct Event
+    {
+        uint64_t time;
+        uint64_t order;         // Keeps interrupts due at the same time in the order they were attached.
+        uint32_t generation;    // Stale if the Timeout has been attached again since.
+        std::shared_ptr<Timeout::Slot> slot;
+
+        bool operator > (const Event &other) const
+        {
+            return (time != other.time) ? (time > other.time) : (order > other.order);
+        }
+    };
+
+    // Every thread is a separate simulation.
+    thread_local std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    thread_local uint64_t simTime = 0;
+    thread_local uint64_t nextOrder = 0;
+    thread_local uint64_t latency = 2;
+    thread_local uint64_t isrTotal = 0;
+    thread_local uint64_t sleepTotal = 0;
+    thread_local uint64_t isrs = 0;
+    thread_local bool inIsr = false;
+
+    /** Throws away cancelled interrupts at the front of the queue. */
+    void dropStale()
+    {
+        while (!events.empty() && events.top().generation != events.top().slot->generation)
+        {
+            events.pop();
+        }
+    }
+
+    /** Services every interrupt that is already due, one after another. */
+    void serviceDue()
+    {
+        while (!events.empty() && events.top().time <= simTime)
+        {
+            Event event = events.top();
+            events.pop();
+            if (event.generation != event.slot->generation)
+            {
+                continue;       // Detached or replaced.
+            }
+            event.slot->generation++;
+            uint64_t entry = simTime;
+            if (sim::onIsr)
+            {
+                sim::onIsr(entry, true);
+            }
+            simTime += latency;
+            inIsr = true;
+            event.slot->function();
+            inIsr = false;
+            if (sim::onIsr)
+            {
+                sim::onIsr(simTime, false);
+            }
+            isrTotal += simTime - entry;
+            isrs++;
+        }
+    }
+}
+
+thread_local std::function<void(uint64_t time, PinName pin, int value)> sim::onPinChange;
+thread_local std::function<void(uint64_t time, bool entering)> sim::onIsr;
+
+// mbed replacements.
+
+DigitalOut::DigitalOut(PinName pin, int value) :
+    pin_(pin),
+    value_(value)
+{
+}
+
+void DigitalOut::write(int value)
+{
+    value = (value != 0);
+    if (value != value_ && sim::onPinChange)
+    {
+        sim::onPinChange(simTime, pin_, value);
+    }
+    value_ = value;
+}
+
+Timeout::Timeout() :
+    slot_(std::make_shared<Slot>())
+{
+}
+
+Timeout::~Timeout()
+{
+    detach();
+}
+
+void Timeout::attach(Callback<void()> function, std::chrono::microseconds delay)
+{
+    slot_->generation++;
+    slot_->function = function;
+    events.push(Event{simTime + (uint64_t)delay.count(), nextOrder++, slot_->generation, slot_});
+}
+
+void Timeout::detach()
+{
+    slot_->generation++;
+}
+
+void wait_us(int us)
+{
+    uint64_t end = simTime + us;
+    if (!inIsr)
+    {
+        while (!events.empty() && events.top().time < end)
+        {
+            simTime = std::max(simTime, events.top().time);     // Interrupted part way through the wait.
+            serviceDue();
+        }
+    }
+    simTime = std::max(simTime, end);
+}
+
+void sleep()
+{
+    dropStale();        // Don't wake up for an interrupt that has been cancelled.
+    if (events.empty())
+    {
+        return;
+    }
+    if (events.top().time > simTime)
+    {
+        sleepTotal += events.top().time - simTime;
+        simTime = events.top().time;
+    }
+    serviceDue();
+}
+
+void __disable_irq()
+{
+}
+
+void __enable_irq()
+{
+}
+
+uint32_t us_ticker_read()
+{
+    return (uint32_t)simTime;
+}
+
+// Simulation controls.
+
+uint64_t sim::now()
+{
+    return simTime;
+}
+
+void sim::reset()
+{
+    events = decltype(events)();
+    simTime = 0;
+    nextOrder = 0;
+    latency = 2;
+    isrTotal = 0;
+    sleepTotal = 0;
+    isrs = 0;
+    inIsr = false;
+    onPinChange = nullptr;
+    onIsr = nullptr;
+}
+
+void sim::setIsrLatency(std::chrono::microseconds isrLatency)
+{
+    latency = isrLatency.count();
+}
+
+void sim::runUntil(uint64_t time)
+{
+    dropStale();
+    while (!events.empty() && events.top().time <= time)
+    {
+        sleep();
+        dropStale();
+    }
+    if (time > simTime)
+    {
+        sleepTotal += time - simTime;
+        simTime = time;
+    }
+}
+
+uint64_t sim::isrTime()
+{
+    return isrTotal;
+}
+
+uint64_t sim::sleepTime()
+{
+    return sleepTotal;
+}
+
+uint64_t sim::isrCount()
+{
+    return isrs;
+}
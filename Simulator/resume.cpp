@@ -0,0 +1,82 @@
+/* Host benchmark of what it costs to resume the ServoList cycle.
+ * Times a Timeout that does nothing but re-attach itself, then an empty ServoList whose cycle does nothing
+ * but wait, and takes one from the other. The two are run in turn for a number of rounds, so drift in the host's
+ * speed hits both, and the median and spread of the differences are reported rather than one run.
+ * Build with -DSERVO_COROUTINES=0 to time the state machine instead.
+ *
+ * Usage: Resume [resumes per run] [rounds]
+ */
+#include "../servos.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/** A Timeout that re-attaches itself, the cheapest ISR the simulator can run. */
+class Bare
+{
+public:
+    Timeout timer_;
+    void fire(){ timer_.attach(callback(this, &Bare::fire), 100us); }
+};
+
+/** Host time per ISR while the simulation runs for a length of virtual time, in ns. */
+static double timePerIsr(uint64_t length)
+{
+    uint64_t isrs = sim::isrCount();
+    uint64_t end = sim::now() + length;
+    auto start = std::chrono::steady_clock::now();
+    sim::runUntil(end);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (sim::isrCount() - isrs);
+}
+
+/** Value at a percentile of a sorted list of samples. */
+static double percentile(const std::vector<double> &sorted, double percent)
+{
+    return sorted[(size_t)(percent / 100.0 * (sorted.size() - 1) + 0.5)];
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t resumes = (argc > 1) ? strtoull(argv[1], NULL, 10) : 200000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 15;
+    uint64_t length = resumes * 100;        // One ISR every 100us.
+    sim::setIsrLatency(0us);
+    if (rounds < 1)
+    {
+        rounds = 1;
+    }
+
+    Bare bare;
+    ServoList empty(500us, 2500us, 100us);  // No servos, so the cycle only waits for the next cycle.
+    std::vector<double> bareNs, emptyNs, overheadNs;
+    for (int round = 0; round < rounds; round++)
+    {
+        bare.fire();
+        timePerIsr(length / 10);            // Warm up.
+        bareNs.push_back(timePerIsr(length));
+        bare.timer_.detach();
+
+        empty.start();
+        timePerIsr(length / 10);
+        emptyNs.push_back(timePerIsr(length));
+        empty.end();
+        sim::runUntil(sim::now() + 1000);   // Let the cycle see end() and stop.
+
+        overheadNs.push_back(emptyNs.back() - bareNs.back());
+    }
+    std::sort(bareNs.begin(), bareNs.end());
+    std::sort(emptyNs.begin(), emptyNs.end());
+    std::sort(overheadNs.begin(), overheadNs.end());
+
+    printf("%s, %d rounds of %llu resumes\n", SERVO_COROUTINES ? "coroutine" : "state machine", rounds,
+           (unsigned long long)resumes);
+    printf("bare Timeout ISR:   median %.1f ns\n", percentile(bareNs, 50));
+    printf("empty cycle resume: median %.1f ns\n", percentile(emptyNs, 50));
+    printf("resume overhead:    median %.1f ns, p25 %.1f ns, p75 %.1f ns, min %.1f ns, max %.1f ns\n",
+           percentile(overheadNs, 50), percentile(overheadNs, 25), percentile(overheadNs, 75),
+           overheadNs.front(), overheadNs.back());
+    return 0;
+}
@@ -0,0 +1,424 @@
+/* Randomised stress and timing regression benchmark for the ServoList class.
+ * Fires a random stream of updates, adds and removes at the list while it runs against the virtual clock,
+ * and checks every pulse against the position the servo was set to when the pulse started.
+ *
+ * Usage: Stress [-s seed] [-t seconds] [-r operations per second] [-e tolerance us] [-o results.csv]
+ *   -o appends one CSV row per run so results can be compared between versions.
+ * Returns 1 if any check failed.
+ */
+#include "../servos.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const PinName FRAMEPIN = 1 << 30;
+
+/** What the benchmark expects of one pin. */
+struct PinState
+{
+    bool live = false;              // The servo is in the list.
+    uint16_t index = 0;             // Its index in the list.
+    uint8_t position = 0;           // The last position it was set to.
+    uint64_t addedAt = 0;           // Time it was added.
+    bool high = false;              // The pin is high.
+    bool aborted = false;           // The current pulse was cut short by a remove.
+    uint64_t riseTime = 0;          // Time the current pulse started.
+    int expectedWidth = 0;          // Width the current pulse should be, in us.
+    int pulses = 0;                 // Pulses started this frame.
+    bool moved = false;             // A remove this frame pulled it into a group that had already been turned on.
+};
+
+/** Results of a run. */
+struct Results
+{
+    uint64_t updates = 0, adds = 0, removes = 0, reindexes = 0, lookups = 0;
+    uint64_t frames = 0, pulses = 0;
+    uint64_t missed = 0;            // A servo in the list all frame that didn't pulse.
+    uint64_t skipped = 0;           // Missed pulses by servos a remove pulled into a group that had already been turned on.
+    uint64_t extra = 0;             // More than one pulse in a frame.
+    uint64_t ghosts = 0;            // Pulses on a pin that isn't in the list.
+    uint64_t badWidths = 0;         // Pulses further than the tolerance from the expected width.
+    uint64_t wrongResults = 0;      // add, remove or getPosition disagreeing with the model.
+    std::vector<uint32_t> updateNs; // Host time taken by each updatePosition.
+    std::vector<uint32_t> buildNs;  // Host time taken by each start of cycle ISR.
+    std::vector<uint32_t> planNs;   // Host time taken planning each cycle, while the frame pin is high.
+    std::vector<uint32_t> errorUs;  // Absolute pulse width error.
+};
+
+static std::vector<PinState> pins;
+static Results results;
+static int tolerance = 10;
+static std::vector<bool> indexUsed(65536);     // Indices held by servos in the list, the list takes 16 bit indices.
+static uint16_t nextIndex = 0;
+static uint64_t frameStart = 0;
+static std::vector<int> order;                  // Pins in the order the list holds them.
+static uint32_t dirtyGroups = 0;                // Groups the list will sort before it next turns them on, as in ServoList.
+static int groupsOn = 0;                        // Groups turned on so far this frame.
+static bool inFrameIsr = false;
+static std::chrono::steady_clock::time_point isrEntry;
+static std::chrono::steady_clock::time_point planStart;
+static int minOnTimeUs = 0;                     // Timings of the list under test, read from it before it starts.
+static int maxOnTimeUs = 0;
+static int groupTimeUs = 0;
+static int groupSize = 0;
+
+/** Expected pulse width for a position, in us, the same sum ServoNode::setPosition does. */
+static int expectedWidth(uint8_t position)
+{
+    return minOnTimeUs + ((maxOnTimeUs - minOnTimeUs) * position / 256);
+}
+
+/** Value at a percentile of a list of samples, sorts the samples. */
+static uint32_t percentile(std::vector<uint32_t> &samples, double percent)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t place = (size_t)(percent / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[place];
+}
+
+/** Returns an index no servo in the list holds, without taking it, going round all 16 bit indices before reusing one. */
+static uint16_t freeIndex()
+{
+    while (indexUsed[nextIndex])
+    {
+        nextIndex++;
+    }
+    return nextIndex;
+}
+
+/** Sorts a group of the model the way the list does, by on time, keeping equal servos in order. */
+static void sortGroup(int group)
+{
+    size_t first = std::min(order.size(), (size_t)(group * groupSize));
+    size_t last = std::min(order.size(), first + groupSize);
+    std::stable_sort(order.begin() + first, order.begin() + last, [](int a, int b)
+    {
+        return expectedWidth(pins[a].position) < expectedWidth(pins[b].position);
+    });
+    dirtyGroups &= ~(1u << group);
+}
+
+/** Group of the list a pin is held in. */
+static int groupOf(int pinNo)
+{
+    return (int)(std::find(order.begin(), order.end(), pinNo) - order.begin()) / groupSize;
+}
+
+/** Checks the frame that has just finished, every servo that was in the list throughout should have pulsed once. */
+static void endFrame(uint64_t time)
+{
+    if (results.frames > 0)
+    {
+        for (PinState &pin : pins)
+        {
+            if (pin.pulses > 1)
+            {
+                results.extra++;
+            } else if (pin.live && pin.pulses == 0 && pin.addedAt < frameStart)
+            {
+                if (pin.moved)
+                {
+                    results.skipped++;
+                } else
+                {
+                    results.missed++;
+                }
+            }
+        }
+    }
+    for (PinState &pin : pins)
+    {
+        pin.pulses = 0;
+        pin.moved = false;
+    }
+    while (dirtyGroups)         // The list sorts every changed group as the frame starts.
+    {
+        sortGroup(__builtin_ctz(dirtyGroups));
+    }
+    groupsOn = 0;
+    frameStart = time;
+    results.frames++;
+}
+
+static void pinChange(uint64_t time, PinName pinNo, int value)
+{
+    if (pinNo == FRAMEPIN)
+    {
+        if (value)
+        {
+            inFrameIsr = true;
+            endFrame(time);
+            planStart = std::chrono::steady_clock::now();
+        } else
+        {
+            results.planNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - planStart).count());
+        }
+        return;
+    }
+    PinState &pin = pins[pinNo];
+    if (value)
+    {
+        if (!pin.live)
+        {
+            results.ghosts++;
+        }
+        pin.high = true;
+        pin.aborted = false;
+        pin.riseTime = time;
+        pin.expectedWidth = expectedWidth(pin.position);
+        int group = (int)((time - frameStart) / groupTimeUs);      // Groups turn on one group time apart, in list order.
+        if (group >= groupsOn)
+        {
+            if (dirtyGroups & (1u << group))   // Changed since the frame started, the list sorts it again first.
+            {
+                sortGroup(group);
+            }
+            groupsOn = group + 1;
+        }
+        pin.pulses++;
+        results.pulses++;
+    } else if (pin.high)
+    {
+        pin.high = false;
+        if (!pin.aborted)
+        {
+            int error = abs((int)(time - pin.riseTime) - pin.expectedWidth);
+            results.errorUs.push_back(error);
+            if (error > tolerance)
+            {
+                results.badWidths++;
+            }
+        }
+    }
+}
+
+static void isr(uint64_t /*time*/, bool entering)
+{
+    if (entering)
+    {
+        isrEntry = std::chrono::steady_clock::now();
+    } else if (inFrameIsr)
+    {
+        inFrameIsr = false;
+        results.buildNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - isrEntry).count());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = 1;
+    int seconds = 10;
+    int rate = 5000;
+    const char *csvFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            seed = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            tolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            csvFile = argv[++i];
+        } else
+        {
+            printf("Usage: %s [-s seed] [-t seconds] [-r operations per second] [-e tolerance us] [-o results.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint64_t endTime = (uint64_t)seconds * 1000000;
+    std::mt19937 random(seed);
+
+    sim::onPinChange = pinChange;
+    sim::onIsr = isr;
+
+    ServoList servos;
+    servos.setFramePin(FRAMEPIN);
+    minOnTimeUs = (int)servos.getMinOnTime().count();
+    maxOnTimeUs = (int)servos.getMaxOnTime().count();
+    groupTimeUs = (int)servos.getGroupTime().count();
+    groupSize = servos.getGroupSize();
+    std::vector<int> live;          // Pins of the servos in the list.
+    int nextPin = 0;
+
+    // Find out how many servos fit, then start from empty.
+    int capacity = 0;
+    while (servos.add((PinName)nextPin, 0, (uint16_t)nextPin))
+    {
+        nextPin++;
+        capacity++;
+    }
+    for (int i = 0; i < capacity; i++)
+    {
+        servos.remove(i);
+    }
+    pins.resize(nextPin);
+
+    servos.start();
+    while (sim::now() < endTime)
+    {
+        sim::runUntil(sim::now() + random() % (2000000 / rate + 1));
+
+        int op = random() % 100;
+        if (op < 80 && !live.empty())
+        {
+            int pinNo = live[random() % live.size()];
+            PinState &pin = pins[pinNo];
+            uint8_t position = random() % 256;
+            auto start = std::chrono::steady_clock::now();
+            servos.updatePosition(pin.index, position);
+            results.updateNs.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            pin.position = position;
+            dirtyGroups |= 1u << groupOf(pinNo);
+            results.updates++;
+        } else if (op < 89)
+        {
+            int pinNo = nextPin++;
+            pins.emplace_back();
+            PinState &pin = pins[pinNo];
+            pin.index = freeIndex();
+            pin.position = random() % 256;
+            int added = servos.add((PinName)pinNo, pin.position, pin.index);
+            if (added != ((int)live.size() < capacity))
+            {
+                results.wrongResults++;
+            }
+            if (added)
+            {
+                pin.live = true;
+                order.push_back(pinNo);             // Added to the end.
+                dirtyGroups |= 1u << ((order.size() - 1) / groupSize);
+                indexUsed[pin.index] = true;
+                pin.addedAt = sim::now();
+                live.push_back(pinNo);
+            }
+            results.adds++;
+        } else if (op < 98)
+        {
+            int place = live.empty() ? -1 : (int)(random() % (live.size() + 1));
+            if (place < 0 || place == (int)live.size())
+            {
+                if (servos.remove(freeIndex()) != 0)     // Not in the list.
+                {
+                    results.wrongResults++;
+                }
+            } else
+            {
+                PinState &pin = pins[live[place]];
+                pin.aborted = true;
+                if (servos.remove(pin.index) != 1)
+                {
+                    results.wrongResults++;
+                }
+                pin.live = false;
+                indexUsed[pin.index] = false;
+                int pinNo = live[place];
+                live.erase(live.begin() + place);
+                // Everything after the gap moves down one, so the first servo of the group waiting to be turned on
+                // drops into the last group turned on, and misses this frame, if the gap is in a group already turned on.
+                int group = groupOf(pinNo);
+                if (group < groupsOn && groupsOn * groupSize < (int)order.size())
+                {
+                    pins[order[groupsOn * groupSize]].moved = true;
+                }
+                order.erase(std::find(order.begin(), order.end(), pinNo));
+                dirtyGroups |= ~0u << group;        // Every group after the gap has moved.
+            }
+            results.removes++;
+        } else if (op < 99 && !live.empty())
+        {
+            uint16_t newIndex = freeIndex();
+            PinState &pin = pins[live[random() % live.size()]];
+            servos.updateIndex(pin.index, newIndex);
+            indexUsed[pin.index] = false;
+            indexUsed[newIndex] = true;
+            pin.index = newIndex;
+            results.reindexes++;
+        } else if (!live.empty())
+        {
+            PinState &pin = pins[live[random() % live.size()]];
+            if (servos.getPosition(pin.index) != pin.position)
+            {
+                results.wrongResults++;
+            }
+            results.lookups++;
+        }
+    }
+    servos.end();
+    sim::runUntil(sim::now() + 20000);     // Let the last cycle finish.
+
+    uint64_t failures = results.missed + results.extra + results.ghosts + results.badWidths + results.wrongResults;
+    uint32_t updateP50 = percentile(results.updateNs, 50), updateP99 = percentile(results.updateNs, 99);
+    uint32_t buildP50 = percentile(results.buildNs, 50), buildP99 = percentile(results.buildNs, 99);
+    uint32_t planP50 = percentile(results.planNs, 50), planP99 = percentile(results.planNs, 99);
+    uint64_t sortingNs = 0;         // Updates sort their group, or leave it for the plan to sort, so count both.
+    for (uint32_t ns : results.updateNs)
+    {
+        sortingNs += ns;
+    }
+    for (uint32_t ns : results.planNs)
+    {
+        sortingNs += ns;
+    }
+    uint32_t sortingPerFrame = results.frames ? (uint32_t)(sortingNs / results.frames) : 0;
+    uint32_t errorP50 = percentile(results.errorUs, 50), errorP99 = percentile(results.errorUs, 99);
+    uint32_t errorMax = results.errorUs.empty() ? 0 : results.errorUs.back();
+
+    printf("seed %u, %d s, capacity %d servos\n", seed, seconds, capacity);
+    printf("operations: %llu updates, %llu adds, %llu removes, %llu reindexes, %llu lookups\n",
+           (unsigned long long)results.updates, (unsigned long long)results.adds, (unsigned long long)results.removes,
+           (unsigned long long)results.reindexes, (unsigned long long)results.lookups);
+    printf("frames %llu, pulses %llu\n", (unsigned long long)results.frames, (unsigned long long)results.pulses);
+    printf("update latency: p50 %u ns, p99 %u ns\n", updateP50, updateP99);
+    printf("frame build:    p50 %u ns, p99 %u ns\n", buildP50, buildP99);
+    printf("frame plan:     p50 %u ns, p99 %u ns\n", planP50, planP99);
+    printf("updates + plan: %u ns per frame\n", sortingPerFrame);
+    printf("timing error:   p50 %u us, p99 %u us, max %u us\n", errorP50, errorP99, errorMax);
+    printf("missed %llu (skipped after remove %llu), extra %llu, ghost %llu, bad width %llu, wrong result %llu\n",
+           (unsigned long long)results.missed, (unsigned long long)results.skipped, (unsigned long long)results.extra,
+           (unsigned long long)results.ghosts, (unsigned long long)results.badWidths, (unsigned long long)results.wrongResults);
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+
+    if (csvFile)
+    {
+        FILE *csv = fopen(csvFile, "a+");
+        if (!csv)
+        {
+            printf("Could not open %s\n", csvFile);
+            return 1;
+        }
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) == 0)
+        {
+            fprintf(csv, "seed,seconds,rate,updates,adds,removes,frames,pulses,update_p50_ns,update_p99_ns,"
+                         "build_p50_ns,build_p99_ns,plan_p50_ns,plan_p99_ns,sorting_ns_per_frame,error_p50_us,error_p99_us,error_max_us,missed,skipped,extra,"
+                         "ghosts,bad_widths,wrong_results\n");
+        }
+        fprintf(csv, "%u,%d,%d,%llu,%llu,%llu,%llu,%llu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                seed, seconds, rate, (unsigned long long)results.updates, (unsigned long long)results.adds,
+                (unsigned long long)results.removes, (unsigned long long)results.frames, (unsigned long long)results.pulses,
+                updateP50, updateP99, buildP50, buildP99, planP50, planP99, sortingPerFrame, errorP50, errorP99, errorMax,
+                (unsigned long long)results.missed, (unsigned long long)results.skipped, (unsigned long long)results.extra,
+                (unsigned long long)results.ghosts, (unsigned long long)results.badWidths, (unsigned long long)results.wrongResults);
+        fclose(csv);
+    }
+    return failures ? 1 : 0;
+}
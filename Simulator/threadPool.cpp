@@ -0,0 +1,122 @@
+#include "threadPool.h"
+
+ThreadPool::ThreadPool(unsigned threads) :
+    remaining_(0),
+    batch_(0),
+    stopping_(false)
+{
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    for (unsigned i = 0; i < threads; i++)
+    {
+        queues_.emplace_back(new Queue);
+    }
+    for (unsigned i = 1; i < threads; i++)
+    {
+        threads_.emplace_back(&ThreadPool::loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+bool ThreadPool::take(size_t worker, size_t &job)
+{
+    {
+        Queue &own = *queues_[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues_.size(); i++)
+    {
+        Queue &victim = *queues_[(worker + i) % queues_.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();      // Steal from the other end to the owner.
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t worker)
+{
+    size_t job;
+    while (take(worker, job))
+    {
+        task_(job);
+        std::lock_guard<std::mutex> guard(lock_);
+        if (--remaining_ == 0)
+        {
+            done_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::loop(size_t worker)
+{
+    unsigned seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(lock_);
+            wake_.wait(guard, [&]() { return stopping_ || batch_ != seen; });
+            if (stopping_)
+            {
+                return;
+            }
+            seen = batch_;
+        }
+        work(worker);
+    }
+}
+
+void ThreadPool::run(size_t count, std::function<void(size_t)> task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock_);       // Before any job is queued, a worker may still be looking.
+        task_ = task;
+        remaining_ = count;
+    }
+    for (size_t job = 0; job < count; job++)
+    {
+        Queue &queue = *queues_[job % queues_.size()];      // Deal the jobs out like cards.
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.jobs.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        batch_++;
+    }
+    wake_.notify_all();
+    work(0);
+    std::unique_lock<std::mutex> guard(lock_);
+    done_.wait(guard, [&]() { return remaining_ == 0; });
+}
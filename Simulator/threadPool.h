@@ -0,0 +1,65 @@
+/* Work stealing thread pool for the simulator.
+ * Each worker has its own queue of jobs and takes from the back of it, a worker that runs out
+ * takes from the front of someone else's, so long jobs don't leave the other cores waiting.
+ */
+#ifndef SIM_THREAD_POOL_H
+#define SIM_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+    /** One worker's jobs. */
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;    // One per worker, the calling thread is worker 0.
+    std::vector<std::thread> threads_;              // Workers 1 and up.
+    std::function<void(size_t)> task_;              // What to do with each job number.
+    std::mutex lock_;                               // Guards everything below.
+    std::condition_variable wake_;                  // Workers wait on this for a new batch.
+    std::condition_variable done_;                  // run() waits on this for the batch to finish.
+    size_t remaining_;                              // Jobs in the batch not finished yet.
+    unsigned batch_;                                // Counts batches so the workers can tell a new one.
+    bool stopping_;                                 // Set by the destructor.
+
+    /** Takes a job, own queue first then the others. Returns false if there is nothing left. */
+    bool take(size_t worker, size_t &job);
+
+    /** Runs jobs until there are none left. */
+    void work(size_t worker);
+
+    /** Worker thread, waits for a batch then works on it. */
+    void loop(size_t worker);
+
+public:
+    /** Starts the workers.
+     * @param threads, Number of threads including the caller. 0 for one per core.
+     */
+    ThreadPool(unsigned threads = 0);
+
+    /** Stops and joins the workers. */
+    ~ThreadPool();
+
+    /** Number of threads including the caller. */
+    size_t size(){ return queues_.size(); }
+
+    /** Runs task(0) to task(count - 1) across the workers and the calling thread, returns when all are done.
+     * @param count, The number of jobs.
+     * @param task, Called once for each job number, from any thread.
+     */
+    void run(size_t count, std::function<void(size_t)> task);
+};
+
+#endif
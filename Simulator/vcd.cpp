@@ -0,0 +1,167 @@
+#include "vcd.h"
+#include <cstring>
+
+VcdWriter::VcdWriter(const char *fileName, size_t bufferSize) :
+    file_(fopen(fileName, "wb")),
+    buffer_(bufferSize),
+    used_(0),
+    lastTime_(0),
+    started_(false)
+{
+}
+
+VcdWriter::~VcdWriter()
+{
+    if (started_)
+    {
+        sim::onPinChange = nullptr;
+        sim::onIsr = nullptr;
+    }
+    if (file_)
+    {
+        flush();
+        fclose(file_);
+    }
+}
+
+std::string VcdWriter::makeId(size_t n)
+{
+    std::string id;
+    do
+    {
+        id += (char)('!' + (n % 94));   // '!' to '~' are all allowed.
+        n /= 94;
+    } while (n > 0);
+    return id;
+}
+
+void VcdWriter::put(const char *text, size_t len)
+{
+    if (used_ + len > buffer_.size())
+    {
+        flush();
+        if (len > buffer_.size())
+        {
+            if (file_)
+            {
+                fwrite(text, 1, len, file_);
+            }
+            return;
+        }
+    }
+    memcpy(&buffer_[used_], text, len);
+    used_ += len;
+}
+
+void VcdWriter::flush()
+{
+    if (file_ && used_ > 0)
+    {
+        fwrite(buffer_.data(), 1, used_, file_);
+    }
+    used_ = 0;
+}
+
+void VcdWriter::stamp(uint64_t time)
+{
+    if (time == lastTime_)
+    {
+        return;
+    }
+    lastTime_ = time;
+    char text[24];
+    char *end = text + sizeof(text);
+    char *p = end;
+    *--p = '\n';
+    do
+    {
+        *--p = (char)('0' + time % 10);
+        time /= 10;
+    } while (time > 0);
+    *--p = '#';
+    put(p, end - p);
+}
+
+void VcdWriter::addPin(PinName pin, const char *name)
+{
+    if (started_ || pin < 0)
+    {
+        return;
+    }
+    if ((size_t)pin >= pinIds_.size())
+    {
+        pinIds_.resize(pin + 1);
+        names_.resize(pin + 1);
+        events_.resize(pin + 1);
+    }
+    pinIds_[pin] = makeId(pin + 1);     // Id 0 is kept for the ISR marker.
+    names_[pin] = name;
+    events_[pin] = false;
+}
+
+void VcdWriter::addEvent(PinName pin, const char *name)
+{
+    addPin(pin, name);
+    if (!started_ && pin >= 0)
+    {
+        events_[pin] = true;
+    }
+}
+
+void VcdWriter::start()
+{
+    if (!file_ || started_)
+    {
+        return;
+    }
+    isrId_ = makeId(0);
+    std::string header = "$version Servo simulator $end\n$timescale 1us $end\n$scope module servos $end\n";
+    header += "$var wire 1 " + isrId_ + " isr $end\n";
+    for (size_t i = 0; i < pinIds_.size(); i++)
+    {
+        if (!pinIds_[i].empty())
+        {
+            header += (events_[i] ? "$var event 1 " : "$var wire 1 ") + pinIds_[i] + " " + names_[i] + " $end\n";
+        }
+    }
+    header += "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n0" + isrId_ + "\n";
+    for (size_t i = 0; i < pinIds_.size(); i++)
+    {
+        if (!pinIds_[i].empty() && !events_[i])     // Events have no value to start from.
+        {
+            header += "0" + pinIds_[i] + "\n";
+        }
+    }
+    header += "$end\n";
+    put(header.data(), header.size());
+    lastTime_ = 0;
+    started_ = true;
+
+    sim::onPinChange = [this](uint64_t time, PinName pin, int value) { change(time, pin, value); };
+    sim::onIsr = [this](uint64_t time, bool entering) { isr(time, entering); };
+}
+
+void VcdWriter::change(uint64_t time, PinName pin, int value)
+{
+    if (pin < 0 || (size_t)pin >= pinIds_.size() || pinIds_[pin].empty() || (events_[pin] && !value))
+    {
+        return;
+    }
+    stamp(time);
+    const std::string &id = pinIds_[pin];
+    char text[8];
+    text[0] = value ? '1' : '0';
+    memcpy(text + 1, id.data(), id.size());
+    text[id.size() + 1] = '\n';
+    put(text, id.size() + 2);
+}
+
+void VcdWriter::isr(uint64_t time, bool entering)
+{
+    stamp(time);
+    char text[8];
+    text[0] = entering ? '1' : '0';
+    memcpy(text + 1, isrId_.data(), isrId_.size());
+    text[isrId_.size() + 1] = '\n';
+    put(text, isrId_.size() + 2);
+}
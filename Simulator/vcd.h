@@ -0,0 +1,74 @@
+/* Value change dump (IEEE 1364 VCD) writer for the simulator.
+ * Changes are formatted straight into one large buffer that is only written out when it fills,
+ * so long runs with lots of servos don't spend their time in the file system.
+ */
+#ifndef SIM_VCD_H
+#define SIM_VCD_H
+
+#include "mbed.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class VcdWriter
+{
+private:
+    FILE *file_;
+    std::vector<char> buffer_;          // Pending output, flushed when it fills.
+    size_t used_;                       // Bytes of buffer_ in use.
+    uint64_t lastTime_;                 // Timestamp of the last change written.
+    bool started_;                      // True once the header has been written.
+    std::vector<std::string> pinIds_;   // VCD identifier for each pin, empty if the pin isn't traced.
+    std::vector<std::string> names_;    // Signal name for each pin.
+    std::vector<bool> events_;          // True for pins dumped as events, marked on each rising edge.
+    std::string isrId_;                 // VCD identifier for the ISR marker.
+
+    /** Makes the short identifier for signal number n out of the printable characters. */
+    static std::string makeId(size_t n);
+
+    /** Copies text into the buffer, flushing first if there isn't room. Text bigger than the buffer is written straight out. */
+    void put(const char *text, size_t len);
+
+    /** Writes the timestamp line if time has moved on since the last change. */
+    void stamp(uint64_t time);
+
+    /** Writes out everything in the buffer. */
+    void flush();
+
+public:
+    /** Opens the file, nothing is written until start().
+     * @param fileName, The .vcd file to write to.
+     * @param bufferSize, Size of the output buffer in bytes. Default 1MB.
+     */
+    VcdWriter(const char *fileName, size_t bufferSize = 1 << 20);
+
+    /** Flushes the buffer and closes the file. */
+    ~VcdWriter();
+
+    /** Returns true if the file opened. */
+    bool isOpen(){ return file_ != NULL; }
+
+    /** Adds a pin to the dump, only before start().
+     * @param pin, The pin to trace.
+     * @param name, Name of the signal in the viewer.
+     */
+    void addPin(PinName pin, const char *name);
+
+    /** Adds a pin to the dump as an event, only before start().
+     * For marker pins that go high and low again at the same time, which would be zero width as a wire.
+     * @param pin, The pin to trace, each rising edge is an event.
+     * @param name, Name of the signal in the viewer.
+     */
+    void addEvent(PinName pin, const char *name);
+
+    /** Writes the header and the starting value of every signal. Hooks the writer into the simulation. */
+    void start();
+
+    /** Records a pin change, called from sim::onPinChange. */
+    void change(uint64_t time, PinName pin, int value);
+
+    /** Records the core entering or leaving an ISR, called from sim::onIsr. */
+    void isr(uint64_t time, bool entering);
+};
+
+#endif
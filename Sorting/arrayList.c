@@ -1,18 +1,82 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 
+#ifdef LIST_ALL_BACKENDS
+#define LIST_PREFIX array
+#endif
 #include "list.h"
+#include "listOps.h"
+#include "threadPool.h"
+
+// The vectorised sort needs AVX2, it is compiled in for x86 builds with gcc or clang and only used if the CPU has it.
+// Define SIMD_SORT as 0 to leave it out.
+#ifndef SIMD_SORT
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_SORT 1
+#else
+#define SIMD_SORT 0
+#endif
+#endif
+#if SIMD_SORT
+#include <immintrin.h>
+#define AVX2 __attribute__((target("avx2,popcnt")))
+#endif
 
 /**/
 
 // Define constants
 #define ARRAY_LIST_CAPACITY 50
+#define ARRAY_LIST_GROWTH 2.0       // Default factor the capacity grows by when a list fills up.
+#define ARRAY_LIST_MAX_ENTITIES 0x7fffffff
+#define QUICK_SORT_CUTOFF 16        // Ranges this size or smaller are finished off with insertion sort.
+#define NINTHER_CUTOFF 128          // Ranges bigger than this use the median of three medians as the pivot.
+#define PARALLEL_SORT_CUTOFF 65536  // Ranges this size or smaller are sorted by one thread.
+#define SIMD_SMALL_SORT 16          // Ranges this size or smaller are sorted in two AVX2 registers.
+#define SIMD_PARTITION_MIN 24       // Ranges smaller than this are partitioned one entity at a time.
+#define RADIX_BITS 11               // Bits per radix sort digit, 3 passes cover 32 bit ints.
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES ((32 + RADIX_BITS - 1) / RADIX_BITS)
+#define RADIX_SORT_CUTOFF 1024      // Lists this size or smaller are quick sorted, clearing the counts would cost more.
+#define RADIX_PREFETCH 64           // How far ahead of the radix sort's reads to prefetch.
+#define MIN_MERGE 64                // Lists shorter than this are one binary insertion sort, longer ones use runs.
+#define MIN_GALLOP 7                // Wins in a row before a merge starts galloping.
+#define MAX_RUNS 85                 // Run lengths on the stack grow faster than Fibonacci, 85 covers any int size.
 
 // Declare hidden functions
+struct RunStack;
 void sortSwap(struct List* list, int index_1, int index_2);
-int partition(struct List* list, int low, int high);
-void quickSort(struct List* list, int low, int high);
+void partition(struct List* list, int low, int high, int* lessEnd, int* greaterStart);
+void quickSort(struct List* list, int low, int high, int depthLimit);
+int quickSortDepthLimit(int size);
+void parallelSortTask(struct ThreadPool* pool, int worker, struct PoolTask task);
+int choosePivot(struct List* list, int low, int high);
+int medianOfThree(struct List* list, int a, int b, int c);
+void insertionSortRange(struct List* list, int low, int high);
+void heapSortRange(struct List* list, int low, int high);
+void siftDown(struct List* list, int low, int root, int size);
+int upperBound(struct List* list, int entity);
 int checkListLength(struct List* list);
+int growList(struct List* list, size_t needed);
+int resizeList(struct List* list, size_t capacity);
+void mergeRanges(int* from, int* to, int low, int middle, int high);
+int countRun(int* entities, int low, int high);
+void binaryInsertionSort(int* entities, int low, int high, int start);
+int minRunLength(int n);
+int gallopLeft(int key, int* entities, int length, int hint);
+int gallopRight(int key, int* entities, int length, int hint);
+void mergeCollapse(struct RunStack* stack);
+void mergeForceCollapse(struct RunStack* stack);
+void mergeAt(struct RunStack* stack, int i);
+void mergeLow(struct RunStack* stack, int baseA, int lengthA, int baseB, int lengthB);
+void mergeHigh(struct RunStack* stack, int baseA, int lengthA, int baseB, int lengthB);
+#if SIMD_SORT
+void buildPermutations(void);
+AVX2 void simdQuickSort(struct List* list, int low, int high, int depthLimit);
+AVX2 int simdPartition(int* entities, int low, int high, int pivot, int orEqual);
+AVX2 void simdSortSmall(int* entities, int size);
+#endif
 
 //struct def
 struct List
@@ -21,7 +85,19 @@ struct List
     int capacity;
     int numEntities;
     int isSorted;
+    double growthFactor;
+    int* entities;
+};
+
+struct RunStack
+/* Sorted runs waiting to be merged by the adaptive sort */
+{
     int* entities;
+    int* buffer;            // Scratch space for the shorter run of a merge, half the list is always enough.
+    int minGallop;
+    int count;
+    int base[MAX_RUNS];
+    int length[MAX_RUNS];
 };
 //end struct def
 
@@ -31,11 +107,21 @@ struct List* listConstructor()
     struct List* arrayList;
 
     arrayList = malloc(sizeof(struct List));
+    if (arrayList == NULL)
+    {
+        return NULL;
+    }
     arrayList->entities = malloc(ARRAY_LIST_CAPACITY * sizeof(int));
+    if (arrayList->entities == NULL)
+    {
+        free(arrayList);
+        return NULL;
+    }
 
     arrayList->capacity = ARRAY_LIST_CAPACITY;
     arrayList->numEntities = 0;
     arrayList->isSorted = 1;
+    arrayList->growthFactor = ARRAY_LIST_GROWTH;
 
     return arrayList;
 }
@@ -48,24 +134,221 @@ void listDestructor(struct List* list)
 }
 
 int listAdd(struct List* list, int entity)
-/* Add an entity to a list */
+/* Add an entity to a list, growing it first if it is full */
+{
+    if (checkListLength(list) == 1 && !growList(list, (size_t)list->numEntities + 1))
+    {
+        return 0;
+    }
+    if (list->numEntities > 0 && list->entities[list->numEntities - 1] > entity)
+    {
+        list->isSorted = 0;     // Only an entity lower than the last one breaks the order.
+    }
+    list->entities[list->numEntities] = entity;
+    list->numEntities ++;
+
+    return 1;
+}
+
+int listReserve(struct List* list, size_t capacity)
+/* Makes room for at least capacity entities */
 {
-    if (checkListLength(list) == 1)
+    if (capacity <= (size_t)list->capacity)
     {
-        printf("List full.\n");
-        list->capacity = list->capacity*2;
-        printf("Increasing list to twice capacity\n");
-        list->entities = realloc(list->entities, list->capacity* sizeof(int));
         return 1;
     }
-    else
+    return resizeList(list, capacity);
+}
+
+void listShrinkToFit(struct List* list)
+/* Gives back any room beyond the entities in the list */
+{
+    if (list->numEntities < list->capacity)
+    {
+        resizeList(list, (list->numEntities > 0) ? (size_t)list->numEntities : 1);
+    }
+}
+
+void listSetGrowthFactor(struct List* list, double factor)
+/* Sets how much the capacity is multiplied by when the list fills up */
+{
+    list->growthFactor = (factor > 1.0) ? factor : ARRAY_LIST_GROWTH;
+}
+
+int listSize(struct List* list)
+/* Checks size of list */
+{
+    return list->numEntities;
+}
+
+int listIsEmpty(struct List* list)
+/* Checks if a list is empty */
+{
+    return list->numEntities == 0;
+}
+
+struct List* listFromArray(const int* array, size_t count)
+/* Makes a list from an array */
+{
+    struct List* list = listConstructor();
+
+    if (list == NULL)
+    {
+        return NULL;
+    }
+    if (!listAppendMany(list, array, count))
+    {
+        listDestructor(list);
+        return NULL;
+    }
+    return list;
+}
+
+int listAppendMany(struct List* list, const int* array, size_t count)
+/* Adds an array of entities to the end of a list */
+{
+    size_t needed = (size_t)list->numEntities + count;
+
+    if (needed > (size_t)list->capacity && !growList(list, needed))
+    {
+        return 0;
+    }
+    if (count > 0)
+    {
+        if (list->isSorted)
+        {
+            int last = (list->numEntities > 0) ? list->entities[list->numEntities - 1] : INT_MIN;
+            for (size_t i = 0; i < count && list->isSorted; i++)
+            {
+                list->isSorted = (last <= array[i]);
+                last = array[i];
+            }
+        }
+        memcpy(list->entities + list->numEntities, array, count * sizeof(int));
+        list->numEntities = (int)needed;
+    }
+    return 1;
+}
+
+int listInsert(struct List* list, int index, int entity)
+/* Inserts an entity before the one at index */
+{
+    int wasSorted = list->isSorted;
+
+    if (index < 0 || index > list->numEntities)
+    {
+        return 0;
+    }
+    if (!listAppendMany(list, &entity, 1))      // Makes room at the end...
+    {
+        return 0;
+    }
+    list->isSorted = wasSorted;
+    memmove(&list->entities[index + 1], &list->entities[index],    // ...then shuffles the tail up one.
+            (list->numEntities - 1 - index) * sizeof(int));
+    list->entities[index] = entity;
+    if ((index > 0 && list->entities[index - 1] > entity) ||
+        (index + 1 < list->numEntities && list->entities[index + 1] < entity))
     {
-        list->entities[list->numEntities] = entity;
-        list->numEntities ++;
+        list->isSorted = 0;
     }
-    list->isSorted = 0;
+    return 1;
+}
+
+int listInsertSorted(struct List* list, int entity)
+/* Inserts an entity into a sorted list, after any equal entities */
+{
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+    }
+    return listInsert(list, upperBound(list, entity), entity);
+}
+
+int listInsertSortedMany(struct List* list, const int* array, size_t count)
+/* Sorts an array of entities and merges them into a sorted list */
+{
+    int n = list->numEntities;
+    int* entities;
+    int* batch;
+    int from = n - 1;
+    int take = (int)count - 1;
+    int dest;
+
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+    }
+    if (count == 0)
+    {
+        return 1;
+    }
+    batch = malloc(count * sizeof(int));
+    if (batch == NULL || !listAppendMany(list, array, count))
+    {
+        free(batch);
+        return 0;
+    }
+    entities = list->entities;
+    quickSort(list, n, list->numEntities - 1, quickSortDepthLimit((int)count));     // Sort the batch where it landed...
+    memcpy(batch, &entities[n], count * sizeof(int));
+
+    dest = list->numEntities - 1;       // ...then merge from the back into the room it leaves.
+    while (take >= 0 && from >= 0)
+    {
+        if (batch[take] >= entities[from])      // Batch entities go after equal ones already in the list.
+        {
+            entities[dest--] = batch[take--];
+        }
+        else
+        {
+            entities[dest--] = entities[from--];
+        }
+    }
+    if (take >= 0)
+    {
+        memcpy(entities, batch, (take + 1) * sizeof(int));
+    }
+    free(batch);
+    list->isSorted = 1;
+    return 1;
+}
+
+int listLowerBound(struct List* list, int entity)
+/* Finds the index of the first entity not lower than entity in a sorted list */
+{
+    int low = 0;
+    int high = list->numEntities;
 
-    return 0;
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+    }
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (list->entities[middle] < entity)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int listFind(struct List* list, int entity)
+/* Finds the index of an entity in a sorted list, or -1 if it isn't there */
+{
+    int index = listLowerBound(list, entity);
+
+    if (index < list->numEntities && list->entities[index] == entity)
+    {
+        return index;
+    }
+    return -1;
 }
 
 int checkListLength(struct List* list)
@@ -81,6 +364,68 @@ int checkListLength(struct List* list)
     }
 }
 
+int growList(struct List* list, size_t needed)
+/* Grows a list by its growth factor, or more if needed, returns 0 if there is no memory */
+{
+    size_t capacity = (size_t)(list->capacity * list->growthFactor);
+
+    if (needed > ARRAY_LIST_MAX_ENTITIES)
+    {
+        return 0;
+    }
+    if (capacity < needed)
+    {
+        capacity = needed;
+    }
+    if (capacity > ARRAY_LIST_MAX_ENTITIES)
+    {
+        capacity = ARRAY_LIST_MAX_ENTITIES;
+    }
+    return resizeList(list, capacity);
+}
+
+int resizeList(struct List* list, size_t capacity)
+/* Reallocates a list's entities to hold capacity of them, the list is left as it was if there is no memory */
+{
+    int* entities;
+
+    if (capacity > ARRAY_LIST_MAX_ENTITIES)
+    {
+        return 0;
+    }
+    entities = realloc(list->entities, capacity * sizeof(int));
+    if (entities == NULL)
+    {
+        return 0;
+    }
+    list->entities = entities;
+    list->capacity = (int)capacity;
+    return 1;
+}
+
+void listToArray(struct List* list, int* array)
+/* Copies a list into an array */
+{
+    for (int i = 0; i < list->numEntities; i++)
+    {
+        array[i] = list->entities[i];
+    }
+}
+
+const char* listBackendName(void)
+/* Name of this list implementation */
+{
+    return "array";
+}
+
+const struct ListOps listOps =
+/* This list implementation's functions, for programs that compare it with the others */
+{
+    "array", listConstructor, listDestructor, listIsEmpty, listSize, listAdd, listFromArray, listAppendMany,
+    listInsert, listToArray, listInsertSorted, listInsertSortedMany, listLowerBound, listFind, sortQuick, sortBubble,
+    sortInsertion, sortMerge, sortAdaptive, sortRadix, sortSimd, sortParallel, sortParallelPool
+};
+
 void listDisplay (struct List* list)
 /* Displays a list*/
 {
@@ -102,22 +447,16 @@ void listDisplay (struct List* list)
 void sortInsertion(struct List* list)
 {
     int temp;
-    int added;
+    int j;
 
-    for (int i = 0; i < list -> numEntities; i++){
+    for (int i = 1; i < list -> numEntities; i++){
         temp = list->entities[i];
-        added = 0;
-        for (int j = i-1; j >= 0; j--){
-            if (added == 0){
-                if (temp > list->entities[j]){
-                    list->entities[j+1] = list->entities[j];
-                }
-                else{
-                    list->entities[j] = temp;
-                    added = 1;
-                }
-            }
+        j = i-1;
+        while (j >= 0 && list->entities[j] > temp){
+            list->entities[j+1] = list->entities[j];
+            j--;
         }
+        list->entities[j+1] = temp;
     }
     list->isSorted = 1;
 }
@@ -146,13 +485,257 @@ void sortBubble(struct List* list)
 }
 
 /** This function will sort a list using quick sort.
+ * Introsort: three way partitions around a median of three (or ninther) pivot, insertion sort for small ranges,
+ * and heap sort for any range that recurses too deep, so it is O(n log n) whatever the input.
  * @param list, The array list to be sorted.
  */
 void sortQuick (struct List* list)
 {
     int low = 0;
     int high = list->numEntities - 1;
-    quickSort(list, low, high);
+    quickSort(list, low, high, quickSortDepthLimit(list->numEntities));
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using quick sort split across threads, on a pool of its own.
+ * Starting the threads costs about as much as a small sort, callers sorting many lists should keep a pool and use
+ * sortParallelPool.
+ * @param list,     The array list to be sorted.
+ * @param threads,  The number of threads to use, 0 or less for one per core.
+ */
+void sortParallel(struct List* list, int threads)
+{
+    struct ThreadPool* pool;
+
+    if (threads <= 0)
+    {
+        threads = poolCoreCount();
+    }
+    if (threads == 1 || list->numEntities <= PARALLEL_SORT_CUTOFF)
+    {
+        sortQuick(list);
+        return;
+    }
+    pool = poolConstructor(threads);
+    sortParallelPool(list, pool);
+    if (pool != NULL)
+    {
+        poolDestructor(pool);
+    }
+}
+
+/** This function will sort a list using quick sort split across a pool of threads.
+ * Each partition hands its upper part to the thread pool and carries on with the lower part, idle threads steal
+ * the biggest parts waiting. Parts of PARALLEL_SORT_CUTOFF or less are finished off by sortQuick's own code, so the
+ * result is the same whatever the thread count. The pool runs one sort at a time, so two threads sorting at once
+ * need a pool each.
+ * @param list, The array list to be sorted.
+ * @param pool, The pool from poolConstructor, NULL to sort on the calling thread.
+ */
+void sortParallelPool(struct List* list, struct ThreadPool* pool)
+{
+    struct PoolTask task;
+
+    if (pool == NULL || poolSize(pool) == 1 || list->numEntities <= PARALLEL_SORT_CUTOFF)
+    {
+        sortQuick(list);
+        return;
+    }
+    task.run = parallelSortTask;
+    task.context = list;
+    task.low = 0;
+    task.high = list->numEntities - 1;
+    task.depth = quickSortDepthLimit(list->numEntities);
+
+    poolRun(pool, task);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using a bottom up merge sort.
+ * Runs of 1, 2, 4... entities are merged back and forth between the list and one scratch array. Stable.
+ * @param list, The array list to be sorted.
+ */
+void sortMerge(struct List* list)
+{
+    int n = list->numEntities;
+    int* from = list->entities;
+    int* to = malloc((size_t)list->capacity * sizeof(int));    // It may become the storage, so it needs the capacity.
+    int* temp;
+
+    if (to == NULL)
+    {
+        sortQuick(list);        // Not stable, but better than leaving the list unsorted.
+        return;
+    }
+    for (int width = 1; width < n; width *= 2)
+    {
+        for (int low = 0; low < n; low += 2 * width)
+        {
+            int middle = (low + width < n) ? low + width : n;
+            int high = (low + 2 * width < n) ? low + 2 * width : n;
+            mergeRanges(from, to, low, middle, high);
+        }
+        temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != list->entities)     // Ended up in the scratch array, it becomes the list's storage.
+    {
+        to = list->entities;
+        list->entities = from;
+    }
+    free(to);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using a least significant digit radix sort.
+ * The counts for every digit are taken in one pass over the list, then each digit is scattered by its count's
+ * running total back and forth between the list and one scratch array. A digit every entity shares is skipped.
+ * Entities are sorted as unsigned with the sign bit flipped, so negative values come first.
+ * @param list, The array list to be sorted.
+ */
+void sortRadix(struct List* list)
+{
+    int n = list->numEntities;
+    unsigned int* from = (unsigned int*)list->entities;
+    unsigned int* to;
+    unsigned int* temp;
+    int counts[RADIX_PASSES][RADIX_BUCKETS];
+
+    if (n <= RADIX_SORT_CUTOFF)
+    {
+        sortQuick(list);
+        return;
+    }
+    to = malloc((size_t)list->capacity * sizeof(int));     // It may become the storage, so it needs the capacity.
+    if (to == NULL)
+    {
+        sortQuick(list);
+        return;
+    }
+
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++)
+    {
+        unsigned int key = from[i] ^ 0x80000000u;
+        for (int pass = 0; pass < RADIX_PASSES; pass++)
+        {
+            counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)] ++;
+        }
+    }
+
+    for (int pass = 0; pass < RADIX_PASSES; pass++)
+    {
+        int* count = counts[pass];
+        int shift = pass * RADIX_BITS;
+        int total = 0;
+
+        if (count[((from[0] ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)] == n)
+        {
+            continue;       // Every entity has the same digit here, the pass wouldn't move anything.
+        }
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++)     // Counts become where each digit starts.
+        {
+            int digitCount = count[digit];
+            count[digit] = total;
+            total += digitCount;
+        }
+        for (int i = 0; i < n; i++)
+        {
+#ifdef __GNUC__
+            __builtin_prefetch(&from[i + RADIX_PREFETCH]);
+#endif
+            unsigned int value = from[i];
+            to[count[((value ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++] = value;
+        }
+        temp = from;
+        from = to;
+        to = temp;
+    }
+
+    if (from != (unsigned int*)list->entities)     // Ended up in the scratch array, it becomes the list's storage.
+    {
+        to = (unsigned int*)list->entities;
+        list->entities = (int*)from;
+    }
+    free(to);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using quick sort with AVX2, if the CPU has it, or sortQuick if not.
+ * Partitions split 8 entities at a time by shuffling each vector so the ones going left are at the front, then
+ * storing it at both ends, and ranges of 16 or less are sorted with a bitonic network in two registers. Depth is
+ * limited the same way as sortQuick so bad pivots still fall back to heap sort.
+ * @param list, The array list to be sorted.
+ */
+void sortSimd(struct List* list)
+{
+#if SIMD_SORT
+    if (__builtin_cpu_supports("avx2"))
+    {
+        buildPermutations();
+        simdQuickSort(list, 0, list->numEntities - 1, quickSortDepthLimit(list->numEntities));
+        list->isSorted = 1;
+        return;
+    }
+#endif
+    sortQuick(list);
+}
+
+/** This function will sort a list using natural runs, like TimSort, and does nothing if the list is already sorted.
+ * Ascending runs are kept and strictly descending ones reversed, short runs are topped up to a minimum length with
+ * binary insertion sort, and neighbouring runs are merged while their lengths keep the stack balanced. Merges gallop
+ * through long stretches taken from one side. O(n) on sorted or nearly sorted input, O(n log n) at worst. Stable.
+ * @param list, The array list to be sorted.
+ */
+void sortAdaptive(struct List* list)
+{
+    struct RunStack stack;
+    int n = list->numEntities;
+    int low = 0;
+    int minRun;
+
+    if (list->isSorted || n < 2)
+    {
+        list->isSorted = 1;
+        return;
+    }
+    if (n < MIN_MERGE)
+    {
+        binaryInsertionSort(list->entities, 0, n, countRun(list->entities, 0, n));
+        list->isSorted = 1;
+        return;
+    }
+
+    stack.entities = list->entities;
+    stack.buffer = malloc((n / 2 + 1) * sizeof(int));
+    stack.minGallop = MIN_GALLOP;
+    stack.count = 0;
+    if (stack.buffer == NULL)
+    {
+        sortQuick(list);
+        return;
+    }
+
+    minRun = minRunLength(n);
+    while (low < n)
+    {
+        int runLength = countRun(list->entities, low, n);
+        if (runLength < minRun)
+        {
+            int forced = (n - low < minRun) ? n - low : minRun;
+            binaryInsertionSort(list->entities, low, low + forced, low + runLength);
+            runLength = forced;
+        }
+        stack.base[stack.count] = low;
+        stack.length[stack.count] = runLength;
+        stack.count++;
+        mergeCollapse(&stack);
+        low += runLength;
+    }
+    mergeForceCollapse(&stack);
+
+    free(stack.buffer);
     list->isSorted = 1;
 }
 
@@ -173,39 +756,1050 @@ void sortSwap(struct List* list, int index_1, int index_2)
     list->entities[index_2] = temp;
 }
 
-/** This function is the recursive part of the quick sort algorithm.
- * @param list, The list being sorted.
- * @param low,  The low limit of the section of list being sorted
- * @param high, The high limit/pivot of the section of list being sorted
+/** This function finds where an entity goes in a sorted list, after any equal entities.
+ * @param list,     The sorted list.
+ * @param entity,   The value being placed.
+ * @return,         The index of the first entity greater than it.
  */
-void quickSort(struct List* list, int low, int high)
+int upperBound(struct List* list, int entity)
 {
-    if (high > low)
+    int low = 0;
+    int high = list->numEntities;
+
+    while (low < high)
     {
-        int pivotPoint = partition (list, low, high);
-        quickSort(list, low, pivotPoint - 1);
-        quickSort(list, pivotPoint + 1, high);
+        int middle = low + (high - low) / 2;
+        if (entity < list->entities[middle])
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
     }
+    return low;
 }
 
-/** This function splits a function into two parts, greater than the pivot and lower than or equal to the pivot.
- * @param list, The list being sorted.
- * @param low,  The low limit of the section of list being sorted
- * @param high, The high limit/pivot of the section of list being sorted
+/** This function is the recursive part of the quick sort algorithm.
+ * Recurses into the smaller side and loops on the larger one, so the stack is never more than log2(n) deep.
+ * @param list,         The list being sorted.
+ * @param low,          The low limit of the section of list being sorted
+ * @param high,         The high limit of the section of list being sorted
+ * @param depthLimit,   How many more partitions are allowed before switching to heap sort.
  */
-int partition(struct List* list, int low, int high)
+void quickSort(struct List* list, int low, int high, int depthLimit)
 {
-    int pivotPoint = (low+ high)/2;
-    int pivot = list->entities[pivotPoint];
-    sortSwap(list, low, pivotPoint);
-    pivotPoint = low;
-    for (int i = low + 1; i <= high; ++i)
+    int lessEnd;
+    int greaterStart;
+
+    while (high - low + 1 > QUICK_SORT_CUTOFF)
     {
-        if (list->entities[i] <= pivot)
+        if (depthLimit == 0)
         {
-            sortSwap(list, i, ++pivotPoint);
+            heapSortRange(list, low, high);     // Bad pivots, give up on quick sort for this range.
+            return;
         }
-    }
-    sortSwap(list, low, pivotPoint);
-    return pivotPoint;
-}
+        depthLimit--;
+
+        partition(list, low, high, &lessEnd, &greaterStart);
+        if (lessEnd - low < high - greaterStart)
+        {
+            quickSort(list, low, lessEnd, depthLimit);
+            low = greaterStart;
+        }
+        else
+        {
+            quickSort(list, greaterStart, high, depthLimit);
+            high = lessEnd;
+        }
+    }
+    insertionSortRange(list, low, high);
+}
+
+/** This function works out how deep quick sort can go before heap sort takes over, 2 * log2(size).
+ * @param size, The number of entities being sorted.
+ */
+int quickSortDepthLimit(int size)
+{
+    int depthLimit = 0;
+    for (int n = size; n > 1; n >>= 1)
+    {
+        depthLimit += 2;
+    }
+    return depthLimit;
+}
+
+/** This function is one thread pool task of the parallel sort, it sorts one section of a list.
+ * @param pool,     The pool running the sort.
+ * @param worker,   The thread running this task.
+ * @param task,     The list is the context, low and high the section, depth the quick sort depth limit left.
+ */
+void parallelSortTask(struct ThreadPool* pool, int worker, struct PoolTask task)
+{
+    struct List* list = task.context;
+    struct PoolTask upper;
+    int lessEnd;
+    int greaterStart;
+
+    while (task.high - task.low + 1 > PARALLEL_SORT_CUTOFF && task.depth > 0)
+    {
+        task.depth--;
+        partition(list, task.low, task.high, &lessEnd, &greaterStart);
+        upper = task;
+        upper.low = greaterStart;
+        if (!poolSubmit(pool, worker, upper))
+        {
+            quickSort(list, upper.low, upper.high, upper.depth);    // No room in the queue, sort it here.
+        }
+        task.high = lessEnd;
+    }
+    quickSort(list, task.low, task.high, task.depth);
+}
+
+/** This function splits a section of a list into three parts, lower than, equal to and greater than the pivot.
+ * Runs of equal values end up in the middle and are never looked at again.
+ * @param list,         The list being sorted.
+ * @param low,          The low limit of the section of list being sorted
+ * @param high,         The high limit of the section of list being sorted
+ * @param lessEnd,      Set to the last index of the lower part.
+ * @param greaterStart, Set to the first index of the greater part.
+ */
+void partition(struct List* list, int low, int high, int* lessEnd, int* greaterStart)
+{
+    int* entities = list->entities;
+    int pivot = entities[choosePivot(list, low, high)];
+    int lt = low;       // entities[low..lt-1] < pivot
+    int i = low;        // entities[lt..i-1] == pivot
+    int gt = high;      // entities[gt+1..high] > pivot
+
+    while (i <= gt)
+    {
+        int value = entities[i];
+        if (value < pivot)
+        {
+            entities[i] = entities[lt];
+            entities[lt] = value;
+            lt++;
+            i++;
+        }
+        else if (value > pivot)
+        {
+            entities[i] = entities[gt];
+            entities[gt] = value;
+            gt--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    *lessEnd = lt - 1;
+    *greaterStart = gt + 1;
+}
+
+/** This function picks the index of the pivot for a section of a list.
+ * @param list, The list being sorted.
+ * @param low,  The low limit of the section of list being sorted
+ * @param high, The high limit of the section of list being sorted
+ */
+int choosePivot(struct List* list, int low, int high)
+{
+    int mid = low + (high - low) / 2;
+    if (high - low + 1 > NINTHER_CUTOFF)
+    {
+        int step = (high - low + 1) / 8;
+        int a = medianOfThree(list, low, low + step, low + 2 * step);
+        int b = medianOfThree(list, mid - step, mid, mid + step);
+        int c = medianOfThree(list, high - 2 * step, high - step, high);
+        return medianOfThree(list, a, b, c);
+    }
+    return medianOfThree(list, low, mid, high);
+}
+
+/** This function returns whichever of three indexes holds the middle value.
+ * @param list,     The list being sorted.
+ * @param a, b, c,  The three indexes.
+ */
+int medianOfThree(struct List* list, int a, int b, int c)
+{
+    int va = list->entities[a];
+    int vb = list->entities[b];
+    int vc = list->entities[c];
+    if (va < vb)
+    {
+        return (vb < vc) ? b : ((va < vc) ? c : a);
+    }
+    return (va < vc) ? a : ((vb < vc) ? c : b);
+}
+
+/** This function sorts a small section of a list using insertion sort.
+ * @param list, The list being sorted.
+ * @param low,  The low limit of the section of list being sorted
+ * @param high, The high limit of the section of list being sorted
+ */
+void insertionSortRange(struct List* list, int low, int high)
+{
+    int* entities = list->entities;
+    for (int i = low + 1; i <= high; i++)
+    {
+        int temp = entities[i];
+        int j = i - 1;
+        while (j >= low && entities[j] > temp)
+        {
+            entities[j + 1] = entities[j];
+            j--;
+        }
+        entities[j + 1] = temp;
+    }
+}
+
+/** This function sorts a section of a list using heap sort, the fallback when quick sort goes too deep.
+ * @param list, The list being sorted.
+ * @param low,  The low limit of the section of list being sorted
+ * @param high, The high limit of the section of list being sorted
+ */
+void heapSortRange(struct List* list, int low, int high)
+{
+    int size = high - low + 1;
+    for (int root = size / 2 - 1; root >= 0; root--)
+    {
+        siftDown(list, low, root, size);
+    }
+    for (int end = size - 1; end > 0; end--)
+    {
+        sortSwap(list, low, low + end);     // Largest to the end.
+        siftDown(list, low, 0, end);
+    }
+}
+
+/** This function moves a value down a heap until both its children are smaller.
+ * @param list, The list holding the heap.
+ * @param low,  The index the heap starts at.
+ * @param root, The place in the heap of the value being moved.
+ * @param size, The number of values in the heap.
+ */
+void siftDown(struct List* list, int low, int root, int size)
+{
+    int* heap = list->entities + low;
+    int value = heap[root];
+    int child = 2 * root + 1;
+    while (child < size)
+    {
+        if (child + 1 < size && heap[child + 1] > heap[child])
+        {
+            child++;
+        }
+        if (heap[child] <= value)
+        {
+            break;
+        }
+        heap[root] = heap[child];
+        root = child;
+        child = 2 * root + 1;
+    }
+    heap[root] = value;
+}
+
+/** This function merges two sorted neighbouring ranges into another array, taking from the left range on equal values.
+ * @param from,     The array holding the two ranges.
+ * @param to,       The array the merged range is written to, at the same place.
+ * @param low,      The start of the left range.
+ * @param middle,   The end of the left range and start of the right range.
+ * @param high,     The end of the right range (exclusive).
+ */
+void mergeRanges(int* from, int* to, int low, int middle, int high)
+{
+    int left = low;
+    int right = middle;
+
+    for (int i = low; i < high; i++)
+    {
+        if (left < middle && (right >= high || from[left] <= from[right]))
+        {
+            to[i] = from[left++];
+        }
+        else
+        {
+            to[i] = from[right++];
+        }
+    }
+}
+
+
+// Adaptive sort
+
+/** This function finds the length of the run starting at low, reversing it if it is strictly descending.
+ * @param entities, The array being sorted.
+ * @param low,      The start of the run.
+ * @param high,     The end of the array (exclusive).
+ */
+int countRun(int* entities, int low, int high)
+{
+    int runHigh = low + 1;
+
+    if (runHigh == high)
+    {
+        return 1;
+    }
+    if (entities[runHigh++] < entities[low])
+    {
+        while (runHigh < high && entities[runHigh] < entities[runHigh - 1])
+        {
+            runHigh++;
+        }
+        for (int i = low, j = runHigh - 1; i < j; i++, j--)     // Strictly descending, so reversing keeps it stable.
+        {
+            int temp = entities[i];
+            entities[i] = entities[j];
+            entities[j] = temp;
+        }
+    }
+    else
+    {
+        while (runHigh < high && entities[runHigh] >= entities[runHigh - 1])
+        {
+            runHigh++;
+        }
+    }
+    return runHigh - low;
+}
+
+/** This function sorts a range of an array whose start is already sorted, finding each place with a binary search.
+ * @param entities, The array being sorted.
+ * @param low,      The start of the range.
+ * @param high,     The end of the range (exclusive).
+ * @param start,    The first entity that isn't already in order.
+ */
+void binaryInsertionSort(int* entities, int low, int high, int start)
+{
+    for (int i = start; i < high; i++)
+    {
+        int value = entities[i];
+        int left = low;
+        int right = i;
+
+        while (left < right)        // Goes after any equal values, to stay stable.
+        {
+            int middle = left + (right - left) / 2;
+            if (value < entities[middle])
+            {
+                right = middle;
+            }
+            else
+            {
+                left = middle + 1;
+            }
+        }
+        memmove(&entities[left + 1], &entities[left], (i - left) * sizeof(int));
+        entities[left] = value;
+    }
+}
+
+/** This function picks the shortest run worth merging, between MIN_MERGE / 2 and MIN_MERGE, so that the list
+ * splits into a power of two runs or just under.
+ * @param n, The number of entities being sorted.
+ */
+int minRunLength(int n)
+{
+    int extra = 0;
+    while (n >= MIN_MERGE)
+    {
+        extra |= n & 1;
+        n >>= 1;
+    }
+    return n + extra;
+}
+
+/** This function finds where key goes in a sorted array, before any equal values. It searches out from hint in
+ * steps of 1, 3, 7... and then binary searches the last step, so it is quick when the answer is near the hint.
+ * @param key,      The value being placed.
+ * @param entities, The sorted array.
+ * @param length,   The length of the array, at least 1.
+ * @param hint,     Where to start looking.
+ * @return,         The index of the first entity not lower than key.
+ */
+int gallopLeft(int key, int* entities, int length, int hint)
+{
+    int lastOffset = 0;
+    int offset = 1;
+
+    if (entities[hint] < key)       // Gallop right until entities[hint + lastOffset] < key <= entities[hint + offset].
+    {
+        int maxOffset = length - hint;
+        while (offset < maxOffset && entities[hint + offset] < key)
+        {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+            if (offset <= 0)
+            {
+                offset = maxOffset;
+            }
+        }
+        if (offset > maxOffset)
+        {
+            offset = maxOffset;
+        }
+        lastOffset += hint;
+        offset += hint;
+    }
+    else                            // Gallop left until entities[hint - offset] < key <= entities[hint - lastOffset].
+    {
+        int maxOffset = hint + 1;
+        int temp;
+        while (offset < maxOffset && entities[hint - offset] >= key)
+        {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+            if (offset <= 0)
+            {
+                offset = maxOffset;
+            }
+        }
+        if (offset > maxOffset)
+        {
+            offset = maxOffset;
+        }
+        temp = lastOffset;
+        lastOffset = hint - offset;
+        offset = hint - temp;
+    }
+
+    lastOffset++;
+    while (lastOffset < offset)
+    {
+        int middle = lastOffset + ((offset - lastOffset) >> 1);
+        if (entities[middle] < key)
+        {
+            lastOffset = middle + 1;
+        }
+        else
+        {
+            offset = middle;
+        }
+    }
+    return offset;
+}
+
+/** This function finds where key goes in a sorted array, after any equal values. Searches the same way as gallopLeft.
+ * @param key,      The value being placed.
+ * @param entities, The sorted array.
+ * @param length,   The length of the array, at least 1.
+ * @param hint,     Where to start looking.
+ * @return,         The index of the first entity greater than key.
+ */
+int gallopRight(int key, int* entities, int length, int hint)
+{
+    int lastOffset = 0;
+    int offset = 1;
+
+    if (key < entities[hint])       // Gallop left until entities[hint - offset] <= key < entities[hint - lastOffset].
+    {
+        int maxOffset = hint + 1;
+        int temp;
+        while (offset < maxOffset && key < entities[hint - offset])
+        {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+            if (offset <= 0)
+            {
+                offset = maxOffset;
+            }
+        }
+        if (offset > maxOffset)
+        {
+            offset = maxOffset;
+        }
+        temp = lastOffset;
+        lastOffset = hint - offset;
+        offset = hint - temp;
+    }
+    else                            // Gallop right until entities[hint + lastOffset] <= key < entities[hint + offset].
+    {
+        int maxOffset = length - hint;
+        while (offset < maxOffset && key >= entities[hint + offset])
+        {
+            lastOffset = offset;
+            offset = (offset << 1) + 1;
+            if (offset <= 0)
+            {
+                offset = maxOffset;
+            }
+        }
+        if (offset > maxOffset)
+        {
+            offset = maxOffset;
+        }
+        lastOffset += hint;
+        offset += hint;
+    }
+
+    lastOffset++;
+    while (lastOffset < offset)
+    {
+        int middle = lastOffset + ((offset - lastOffset) >> 1);
+        if (key < entities[middle])
+        {
+            offset = middle;
+        }
+        else
+        {
+            lastOffset = middle + 1;
+        }
+    }
+    return offset;
+}
+
+/** This function merges runs at the top of the stack until, reading down it, each run is longer than the two above
+ * it put together and each is longer than the one above it. That keeps merges balanced and the stack short.
+ * @param stack, The run stack.
+ */
+void mergeCollapse(struct RunStack* stack)
+{
+    int* length = stack->length;
+
+    while (stack->count > 1)
+    {
+        int n = stack->count - 2;
+        if ((n > 0 && length[n - 1] <= length[n] + length[n + 1]) ||
+            (n > 1 && length[n - 2] <= length[n - 1] + length[n]))
+        {
+            if (length[n - 1] < length[n + 1])
+            {
+                n--;
+            }
+        }
+        else if (length[n] > length[n + 1])
+        {
+            break;
+        }
+        mergeAt(stack, n);
+    }
+}
+
+/** This function merges every run left on the stack, once the whole list has been split into runs.
+ * @param stack, The run stack.
+ */
+void mergeForceCollapse(struct RunStack* stack)
+{
+    while (stack->count > 1)
+    {
+        int n = stack->count - 2;
+        if (n > 0 && stack->length[n - 1] < stack->length[n + 1])
+        {
+            n--;
+        }
+        mergeAt(stack, n);
+    }
+}
+
+/** This function merges run i on the stack with run i + 1. Entities at the start of run i that are already below
+ * all of run i + 1, and at the end of run i + 1 that are already above all of run i, are left where they are.
+ * @param stack,    The run stack.
+ * @param i,        The lower of the two runs, the second or third from the top.
+ */
+void mergeAt(struct RunStack* stack, int i)
+{
+    int* entities = stack->entities;
+    int baseA = stack->base[i];
+    int lengthA = stack->length[i];
+    int baseB = stack->base[i + 1];
+    int lengthB = stack->length[i + 1];
+    int k;
+
+    stack->length[i] = lengthA + lengthB;
+    if (i == stack->count - 3)
+    {
+        stack->base[i + 1] = stack->base[i + 2];
+        stack->length[i + 1] = stack->length[i + 2];
+    }
+    stack->count--;
+
+    k = gallopRight(entities[baseB], &entities[baseA], lengthA, 0);
+    baseA += k;
+    lengthA -= k;
+    if (lengthA == 0)
+    {
+        return;
+    }
+    lengthB = gallopLeft(entities[baseA + lengthA - 1], &entities[baseB], lengthB, lengthB - 1);
+    if (lengthB == 0)
+    {
+        return;
+    }
+
+    if (lengthA <= lengthB)
+    {
+        mergeLow(stack, baseA, lengthA, baseB, lengthB);
+    }
+    else
+    {
+        mergeHigh(stack, baseA, lengthA, baseB, lengthB);
+    }
+}
+
+/** This function merges two neighbouring runs front to back, the first run being the shorter and copied out.
+ * Entities are taken one at a time until one run wins MIN_GALLOP times in a row, then the merge gallops, copying
+ * whole stretches found by a search, until the stretches get short again. The first entity of run B is known to go
+ * before run A and the last entity of run A after run B.
+ * @param stack,    The run stack, for the array, scratch buffer and gallop threshold.
+ * @param baseA,    The start of the first run.
+ * @param lengthA,  The length of the first run.
+ * @param baseB,    The start of the second run, straight after the first.
+ * @param lengthB,  The length of the second run.
+ */
+void mergeLow(struct RunStack* stack, int baseA, int lengthA, int baseB, int lengthB)
+{
+    int* entities = stack->entities;
+    int* buffer = stack->buffer;
+    int cursorA = 0;            // In the buffer.
+    int cursorB = baseB;
+    int dest = baseA;
+    int minGallop = stack->minGallop;
+
+    memcpy(buffer, &entities[baseA], lengthA * sizeof(int));
+    entities[dest++] = entities[cursorB++];
+    if (--lengthB == 0)
+    {
+        goto done;
+    }
+    if (lengthA == 1)
+    {
+        goto lastA;
+    }
+
+    for (;;)
+    {
+        int countA = 0;     // Wins in a row for each run.
+        int countB = 0;
+
+        do
+        {
+            if (entities[cursorB] < buffer[cursorA])
+            {
+                entities[dest++] = entities[cursorB++];
+                countB++;
+                countA = 0;
+                if (--lengthB == 0)
+                {
+                    goto done;
+                }
+            }
+            else
+            {
+                entities[dest++] = buffer[cursorA++];
+                countA++;
+                countB = 0;
+                if (--lengthA == 1)
+                {
+                    goto lastA;
+                }
+            }
+        } while ((countA | countB) < minGallop);
+
+        minGallop++;
+        do
+        {
+            minGallop -= (minGallop > 1);       // Galloping is paying off, start it sooner next time.
+            stack->minGallop = minGallop;
+
+            countA = gallopRight(entities[cursorB], &buffer[cursorA], lengthA, 0);
+            if (countA != 0)
+            {
+                memcpy(&entities[dest], &buffer[cursorA], countA * sizeof(int));
+                dest += countA;
+                cursorA += countA;
+                lengthA -= countA;
+                if (lengthA == 1)
+                {
+                    goto lastA;
+                }
+                if (lengthA == 0)
+                {
+                    goto done;
+                }
+            }
+            entities[dest++] = entities[cursorB++];
+            if (--lengthB == 0)
+            {
+                goto done;
+            }
+
+            countB = gallopLeft(buffer[cursorA], &entities[cursorB], lengthB, 0);
+            if (countB != 0)
+            {
+                memmove(&entities[dest], &entities[cursorB], countB * sizeof(int));
+                dest += countB;
+                cursorB += countB;
+                lengthB -= countB;
+                if (lengthB == 0)
+                {
+                    goto done;
+                }
+            }
+            entities[dest++] = buffer[cursorA++];
+            if (--lengthA == 1)
+            {
+                goto lastA;
+            }
+        } while (countA >= MIN_GALLOP || countB >= MIN_GALLOP);
+        minGallop++;                            // Back to one at a time, make it harder to start galloping again.
+        stack->minGallop = minGallop;
+    }
+
+lastA:      // The rest of run B goes before the last entity of run A.
+    memmove(&entities[dest], &entities[cursorB], lengthB * sizeof(int));
+    entities[dest + lengthB] = buffer[cursorA];
+    return;
+done:
+    memcpy(&entities[dest], &buffer[cursorA], lengthA * sizeof(int));
+}
+
+/** This function merges two neighbouring runs back to front, the second run being the shorter and copied out.
+ * Works the same way as mergeLow from the other end.
+ * @param stack,    The run stack, for the array, scratch buffer and gallop threshold.
+ * @param baseA,    The start of the first run.
+ * @param lengthA,  The length of the first run.
+ * @param baseB,    The start of the second run, straight after the first.
+ * @param lengthB,  The length of the second run.
+ */
+void mergeHigh(struct RunStack* stack, int baseA, int lengthA, int baseB, int lengthB)
+{
+    int* entities = stack->entities;
+    int* buffer = stack->buffer;
+    int cursorA = baseA + lengthA - 1;
+    int cursorB = lengthB - 1;          // In the buffer.
+    int dest = baseB + lengthB - 1;
+    int minGallop = stack->minGallop;
+
+    memcpy(buffer, &entities[baseB], lengthB * sizeof(int));
+    entities[dest--] = entities[cursorA--];
+    if (--lengthA == 0)
+    {
+        goto done;
+    }
+    if (lengthB == 1)
+    {
+        goto lastB;
+    }
+
+    for (;;)
+    {
+        int countA = 0;
+        int countB = 0;
+
+        do
+        {
+            if (buffer[cursorB] < entities[cursorA])
+            {
+                entities[dest--] = entities[cursorA--];
+                countA++;
+                countB = 0;
+                if (--lengthA == 0)
+                {
+                    goto done;
+                }
+            }
+            else
+            {
+                entities[dest--] = buffer[cursorB--];
+                countB++;
+                countA = 0;
+                if (--lengthB == 1)
+                {
+                    goto lastB;
+                }
+            }
+        } while ((countA | countB) < minGallop);
+
+        minGallop++;
+        do
+        {
+            minGallop -= (minGallop > 1);
+            stack->minGallop = minGallop;
+
+            countA = lengthA - gallopRight(buffer[cursorB], &entities[baseA], lengthA, lengthA - 1);
+            if (countA != 0)
+            {
+                dest -= countA;
+                cursorA -= countA;
+                memmove(&entities[dest + 1], &entities[cursorA + 1], countA * sizeof(int));
+                lengthA -= countA;
+                if (lengthA == 0)
+                {
+                    goto done;
+                }
+            }
+            entities[dest--] = buffer[cursorB--];
+            if (--lengthB == 1)
+            {
+                goto lastB;
+            }
+
+            countB = lengthB - gallopLeft(entities[cursorA], buffer, lengthB, lengthB - 1);
+            if (countB != 0)
+            {
+                dest -= countB;
+                cursorB -= countB;
+                memcpy(&entities[dest + 1], &buffer[cursorB + 1], countB * sizeof(int));
+                lengthB -= countB;
+                if (lengthB == 1)
+                {
+                    goto lastB;
+                }
+                if (lengthB == 0)
+                {
+                    goto done;
+                }
+            }
+            entities[dest--] = entities[cursorA--];
+            if (--lengthA == 0)
+            {
+                goto done;
+            }
+        } while (countA >= MIN_GALLOP || countB >= MIN_GALLOP);
+        minGallop++;
+        stack->minGallop = minGallop;
+    }
+
+lastB:      // The rest of run A goes after the first entity of run B.
+    dest -= lengthA;
+    cursorA -= lengthA;
+    memmove(&entities[dest + 1], &entities[cursorA + 1], lengthA * sizeof(int));
+    entities[dest] = buffer[cursorB];
+    return;
+done:
+    if (lengthB > 0)
+    {
+        memcpy(&entities[dest - (lengthB - 1)], buffer, lengthB * sizeof(int));
+    }
+}
+
+
+// Vectorised sort
+#if SIMD_SORT
+
+// permutations[mask] moves the lanes set in mask to the front of a vector, in order, and the rest after them.
+static int permutations[256][8];
+static volatile int permutationsBuilt = 0;
+
+/** This function fills in the permutation table the first time it is needed.
+ */
+void buildPermutations(void)
+{
+    if (permutationsBuilt)
+    {
+        return;
+    }
+    for (int mask = 0; mask < 256; mask++)
+    {
+        int place = 0;
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                permutations[mask][place++] = lane;
+            }
+        }
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (!(mask & (1 << lane)))
+            {
+                permutations[mask][place++] = lane;
+            }
+        }
+    }
+    permutationsBuilt = 1;
+}
+
+/** This function is the recursive part of the vectorised quick sort.
+ * Partitions are two way, lower than the pivot and the rest. When nothing is lower the pivot is the smallest
+ * value, so the range is split again into equal to the pivot, which is finished, and greater.
+ * @param list,         The list being sorted.
+ * @param low,          The low limit of the section of the list being sorted
+ * @param high,         The high limit of the section of the list being sorted
+ * @param depthLimit,   How many more partitions before giving up and using heap sort.
+ */
+AVX2 void simdQuickSort(struct List* list, int low, int high, int depthLimit)
+{
+    int* entities = list->entities;
+    int split;
+
+    while (high - low + 1 > SIMD_SMALL_SORT)
+    {
+        if (depthLimit == 0)
+        {
+            heapSortRange(list, low, high);
+            return;
+        }
+        depthLimit--;
+
+        int pivot = entities[choosePivot(list, low, high)];
+        split = simdPartition(entities, low, high + 1, pivot, 0);
+        if (split == low)
+        {
+            low = simdPartition(entities, low, high + 1, pivot, 1);     // Skip past the run equal to the pivot.
+            continue;
+        }
+        if (split - low < high - split + 1)
+        {
+            simdQuickSort(list, low, split - 1, depthLimit);
+            low = split;
+        }
+        else
+        {
+            simdQuickSort(list, split, high, depthLimit);
+            high = split - 1;
+        }
+    }
+    if (high > low)
+    {
+        simdSortSmall(&entities[low], high - low + 1);
+    }
+}
+
+/** This function splits a section of an array into the entities that go left of a pivot and the rest.
+ * One vector is kept back from each end, so there are always 8 free places at whichever end is written to. Each
+ * vector read is shuffled so its left going entities come first, then stored whole at the left write point and
+ * at the right write point, and the write points move on by how many of each it had.
+ * @param entities, The array.
+ * @param low,      The first index of the section.
+ * @param high,     One past the last index of the section.
+ * @param pivot,    The pivot value.
+ * @param orEqual,  0 to send entities lower than the pivot left, 1 to send entities lower or equal to it left.
+ * @return,         The index of the first entity that went right.
+ */
+AVX2 int simdPartition(int* entities, int low, int high, int pivot, int orEqual)
+{
+    int* writeLeft = &entities[low];
+    int* writeRight = &entities[high];
+    int rest[SIMD_PARTITION_MIN];
+    int count;
+
+    if (high - low >= SIMD_PARTITION_MIN)
+    {
+        __m256i pivots = _mm256_set1_epi32(pivot);
+        __m256i firstLeft = _mm256_loadu_si256((__m256i*)&entities[low]);
+        __m256i firstRight = _mm256_loadu_si256((__m256i*)&entities[high - 8]);
+        int* readLeft = &entities[low + 8];
+        int* readRight = &entities[high - 8];
+
+        while (readRight - readLeft >= 8)
+        {
+            __m256i values;
+            if (readLeft - writeLeft <= writeRight - readRight)     // Read from the end with less room.
+            {
+                values = _mm256_loadu_si256((__m256i*)readLeft);
+                readLeft += 8;
+            }
+            else
+            {
+                readRight -= 8;
+                values = _mm256_loadu_si256((__m256i*)readRight);
+            }
+
+            int mask;
+            if (orEqual)
+            {
+                mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(values, pivots))) & 0xFF;
+            }
+            else
+            {
+                mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivots, values)));
+            }
+            __m256i order = _mm256_loadu_si256((__m256i*)permutations[mask]);
+            values = _mm256_permutevar8x32_epi32(values, order);
+            int left = __builtin_popcount(mask);
+            _mm256_storeu_si256((__m256i*)writeLeft, values);
+            _mm256_storeu_si256((__m256i*)(writeRight - 8), values);
+            writeLeft += left;
+            writeRight -= 8 - left;
+        }
+
+        // What is left over plus the two vectors kept back exactly fill the gap between the write points.
+        count = readRight - readLeft;
+        memcpy(rest, readLeft, count * sizeof(int));
+        _mm256_storeu_si256((__m256i*)&rest[count], firstLeft);
+        _mm256_storeu_si256((__m256i*)&rest[count + 8], firstRight);
+        count += 16;
+    }
+    else
+    {
+        count = high - low;
+        memcpy(rest, &entities[low], count * sizeof(int));
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (rest[i] < pivot || (orEqual && rest[i] == pivot))
+        {
+            *writeLeft++ = rest[i];
+        }
+        else
+        {
+            *--writeRight = rest[i];
+        }
+    }
+    return writeLeft - entities;
+}
+
+// One compare and exchange step of a sorting network across the lanes of a register: each lane is paired with
+// the lane order picks, and the lanes set in upper keep the larger of the pair.
+#define NETWORK_STEP(values, order, upper) \
+    do { \
+        __m256i partner = _mm256_permutevar8x32_epi32((values), (order)); \
+        (values) = _mm256_blend_epi32(_mm256_min_epi32((values), partner), _mm256_max_epi32((values), partner), (upper)); \
+    } while (0)
+
+/** This function sorts up to 16 entities with a bitonic network: each half is sorted in its own register, then
+ * one half is reversed and the two are merged. Unused lanes are filled with INT_MAX so they sort to the end.
+ * @param entities, The entities to sort.
+ * @param size,     How many there are, 16 at most.
+ */
+AVX2 void simdSortSmall(int* entities, int size)
+{
+    int buffer[16];
+    __m256i swap1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    __m256i swap2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    __m256i swap4 = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    for (int i = size; i < 16; i++)
+    {
+        buffer[i] = INT_MAX;
+    }
+    memcpy(buffer, entities, size * sizeof(int));
+    __m256i a = _mm256_loadu_si256((__m256i*)&buffer[0]);
+    __m256i b = _mm256_loadu_si256((__m256i*)&buffer[8]);
+
+    // Sort each register: bitonic runs of 2, then 4, then 8.
+    NETWORK_STEP(a, swap1, 0x66);
+    NETWORK_STEP(b, swap1, 0x66);
+    NETWORK_STEP(a, swap2, 0x3C);
+    NETWORK_STEP(b, swap2, 0x3C);
+    NETWORK_STEP(a, swap1, 0x5A);
+    NETWORK_STEP(b, swap1, 0x5A);
+    NETWORK_STEP(a, swap4, 0xF0);
+    NETWORK_STEP(b, swap4, 0xF0);
+    NETWORK_STEP(a, swap2, 0xCC);
+    NETWORK_STEP(b, swap2, 0xCC);
+    NETWORK_STEP(a, swap1, 0xAA);
+    NETWORK_STEP(b, swap1, 0xAA);
+
+    // Merge: a against b reversed puts the lower 8 in one register and the upper 8 in the other.
+    b = _mm256_permutevar8x32_epi32(b, reverse);
+    __m256i lower = _mm256_min_epi32(a, b);
+    __m256i upper = _mm256_max_epi32(a, b);
+    NETWORK_STEP(lower, swap4, 0xF0);
+    NETWORK_STEP(upper, swap4, 0xF0);
+    NETWORK_STEP(lower, swap2, 0xCC);
+    NETWORK_STEP(upper, swap2, 0xCC);
+    NETWORK_STEP(lower, swap1, 0xAA);
+    NETWORK_STEP(upper, swap1, 0xAA);
+
+    _mm256_storeu_si256((__m256i*)&buffer[0], lower);
+    _mm256_storeu_si256((__m256i*)&buffer[8], upper);
+    memcpy(entities, buffer, size * sizeof(int));
+}
+
+#endif
@@ -0,0 +1,512 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "list.h"
+#include "externalSort.h"
+
+// Define constants
+#define CHUNK_MIN_BYTES (1 << 20)           // Smallest chunk sorted in memory.
+#define MERGE_BUFFER_MIN_BYTES (1 << 20)    // Smallest read buffer per run in a merge, so reads stay long and sequential.
+#define TEMP_NAME "sortRunsXXXXXX"
+
+// Declare hidden functions
+struct RunReader;
+int splitRuns(int input, int output, long long entities, long long chunkEntities, void (*sort)(struct List* list));
+int mergePass(int input, int output, long long entities, long long runEntities, int fanIn, int* buffers,
+              size_t bufferEntities);
+int mergeGroup(int input, int output, struct RunReader* readers, int count, int* outBuffer, size_t bufferEntities);
+int fillReader(int input, struct RunReader* reader);
+void siftHeap(struct RunReader** heap, int size, int root);
+int makeTempFile(const char* directory, const char* outputName);
+int readAll(int file, void* data, size_t bytes, off_t offset);
+int writeAll(int file, const void* data, size_t bytes);
+double sortFileSeconds(void);
+
+//struct def
+struct RunReader
+/* One sorted run being read in a merge, a buffer at a time */
+{
+    long long next;         // Index in the file of the next entity to read into the buffer.
+    long long end;          // Index just past the run.
+    int* buffer;
+    size_t capacity;        // Size of the buffer.
+    size_t count;           // Entities in the buffer...
+    size_t place;           // ...and the next one to take.
+};
+//end struct def
+
+/** This function sorts a file of ints into another file, using about memoryBytes of memory whatever their size.
+ * The first pass splits the input into chunks of half the memory, the sort needing the other half for scratch,
+ * and writes each sorted chunk to a run file. Each pass after that merges the runs as many at a time as the memory
+ * gives MERGE_BUFFER_MIN_BYTES or more of buffer, the last one writing the output.
+ * @param inputName,        The file to sort.
+ * @param outputName,       The file to write, replaced if it is there. If it is the input, 0 is returned and
+ *                          the input is left as it was.
+ * @param memoryBytes,      About how much memory to use.
+ * @param tempDirectory,    Where to make the run files, NULL for the output's directory. They are deleted after.
+ * @param sort,             The sort used on each chunk, NULL for sortRadix.
+ * @param stats,            Filled in with what the sort did, or NULL.
+ * @return,                 1 if the output was written, 0 if not.
+ */
+int sortFile(const char* inputName, const char* outputName, size_t memoryBytes, const char* tempDirectory,
+             void (*sort)(struct List* list), struct ExternalSortStats* stats)
+{
+    struct ExternalSortStats done = {0};
+    long long pageEntities = sysconf(_SC_PAGESIZE) / (long long)sizeof(int);
+    long long chunkEntities;
+    long long runEntities;
+    long long entities;
+    struct stat inputStat;
+    struct stat outputStat;
+    int input;
+    int output;
+    int runs[2] = {-1, -1};     // Runs are merged back and forth between two temporary files.
+    int* buffers = NULL;
+    int fanIn;
+    size_t bufferEntities;
+    int ok = 0;
+    double start = sortFileSeconds();
+
+    if (sort == NULL)
+    {
+        sort = sortRadix;
+    }
+    if (memoryBytes < 2 * CHUNK_MIN_BYTES)
+    {
+        memoryBytes = 2 * CHUNK_MIN_BYTES;
+    }
+    chunkEntities = (long long)(memoryBytes / 2 / sizeof(int));
+    chunkEntities -= chunkEntities % pageEntities;      // Chunks start on a page so they can be mapped.
+    if (chunkEntities > 0x7fffffff - pageEntities)
+    {
+        chunkEntities = 0x7fffffff - 0x7fffffff % pageEntities - pageEntities;     // A list holds an int's worth.
+    }
+    fanIn = (int)(memoryBytes / MERGE_BUFFER_MIN_BYTES) - 1;
+    if (fanIn < 2)
+    {
+        fanIn = 2;
+    }
+
+    input = open(inputName, O_RDONLY);
+    if (input < 0)
+    {
+        return 0;
+    }
+    if (fstat(input, &inputStat) != 0 || inputStat.st_size % sizeof(int) != 0)
+    {
+        close(input);
+        return 0;
+    }
+    entities = inputStat.st_size / (long long)sizeof(int);
+    output = open(outputName, O_RDWR | O_CREAT, 0644);     // Not truncated until it is known not to be the input.
+    if (output < 0)
+    {
+        close(input);
+        return 0;
+    }
+    if (fstat(output, &outputStat) != 0 ||
+        (outputStat.st_dev == inputStat.st_dev && outputStat.st_ino == inputStat.st_ino) ||
+        ftruncate(output, 0) != 0)
+    {
+        close(input);
+        close(output);
+        return 0;
+    }
+    done.entities = entities;
+    done.runs = (int)((entities + chunkEntities - 1) / chunkEntities);
+
+    if (done.runs <= 1)      // Fits in memory, the one chunk goes straight to the output.
+    {
+        ok = splitRuns(input, output, entities, chunkEntities, sort);
+        done.splitSeconds = sortFileSeconds() - start;
+        goto finish;
+    }
+
+    runs[0] = makeTempFile(tempDirectory, outputName);
+    if (runs[0] < 0 || !splitRuns(input, runs[0], entities, chunkEntities, sort))
+    {
+        goto finish;
+    }
+    done.splitSeconds = sortFileSeconds() - start;
+
+    bufferEntities = memoryBytes / sizeof(int) / (fanIn + 1);
+    buffers = malloc((fanIn + 1) * bufferEntities * sizeof(int));
+    if (buffers == NULL)
+    {
+        goto finish;
+    }
+    for (runEntities = chunkEntities; runEntities < entities; runEntities *= fanIn)
+    {
+        int from = runs[done.mergePasses % 2];
+        int last = (runEntities * fanIn >= entities);
+        int to;
+
+        if (last)
+        {
+            to = output;
+        }
+        else
+        {
+            if (runs[(done.mergePasses + 1) % 2] < 0)
+            {
+                runs[(done.mergePasses + 1) % 2] = makeTempFile(tempDirectory, outputName);
+            }
+            to = runs[(done.mergePasses + 1) % 2];
+            if (to < 0 || lseek(to, 0, SEEK_SET) != 0)
+            {
+                goto finish;
+            }
+        }
+        if (!mergePass(from, to, entities, runEntities, fanIn, buffers, bufferEntities))
+        {
+            goto finish;
+        }
+        done.mergePasses++;
+    }
+    ok = 1;
+    done.mergeSeconds = sortFileSeconds() - start - done.splitSeconds;
+
+finish:
+    free(buffers);
+    for (int i = 0; i < 2; i++)
+    {
+        if (runs[i] >= 0)
+        {
+            close(runs[i]);
+        }
+    }
+    close(input);
+    if (close(output) != 0)
+    {
+        ok = 0;
+    }
+    if (stats != NULL)
+    {
+        *stats = done;
+    }
+    return ok;
+}
+
+
+// Hidden functions
+
+/** This function sorts a file a chunk at a time, each chunk mapped in, copied into a list, unmapped, sorted, and
+ * copied straight into the output through a mapping, so only the list and the sort's scratch take up memory.
+ * @param input,            The file to sort.
+ * @param output,           The file to write the sorted chunks to, at the same places.
+ * @param entities,         The number of ints in the input.
+ * @param chunkEntities,    The number of ints in each chunk, a whole number of pages.
+ * @param sort,             The sort used on each chunk.
+ * @return,                 1 if it worked, 0 if not.
+ */
+int splitRuns(int input, int output, long long entities, long long chunkEntities, void (*sort)(struct List* list))
+{
+    if (ftruncate(output, (off_t)(entities * sizeof(int))) != 0)
+    {
+        return 0;
+    }
+    for (long long start = 0; start < entities; start += chunkEntities)
+    {
+        long long count = (entities - start < chunkEntities) ? entities - start : chunkEntities;
+        size_t bytes = (size_t)count * sizeof(int);
+        off_t offset = (off_t)(start * sizeof(int));
+        struct List* list;
+        int* window;
+
+        window = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, input, offset);
+        if (window == MAP_FAILED)
+        {
+            return 0;
+        }
+        posix_madvise(window, bytes, POSIX_MADV_SEQUENTIAL);
+        list = listFromArray(window, (size_t)count);
+        munmap(window, bytes);
+        if (list == NULL)
+        {
+            return 0;
+        }
+
+        sort(list);
+
+        window = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, output, offset);
+        if (window == MAP_FAILED)
+        {
+            listDestructor(list);
+            return 0;
+        }
+        listToArray(list, window);
+        listDestructor(list);
+        munmap(window, bytes);
+    }
+    return 1;
+}
+
+/** This function merges each group of fanIn neighbouring runs in a file into one run in another file.
+ * @param input,            The file of runs.
+ * @param output,           The file to write the merged runs to, from where it is now.
+ * @param entities,         The number of ints in the file.
+ * @param runEntities,      The length of each run, the last can be shorter.
+ * @param fanIn,            How many runs to merge at once.
+ * @param buffers,          Room for fanIn + 1 buffers.
+ * @param bufferEntities,   The size of each buffer.
+ * @return,                 1 if it worked, 0 if not.
+ */
+int mergePass(int input, int output, long long entities, long long runEntities, int fanIn, int* buffers,
+              size_t bufferEntities)
+{
+    struct RunReader* readers = malloc(fanIn * sizeof(struct RunReader));
+    int ok = 1;
+
+    if (readers == NULL)
+    {
+        return 0;
+    }
+    for (long long start = 0; start < entities && ok; start += runEntities * fanIn)
+    {
+        int count = 0;
+        for (long long run = start; run < entities && count < fanIn; run += runEntities, count++)
+        {
+            readers[count].next = run;
+            readers[count].end = (entities - run < runEntities) ? entities : run + runEntities;
+            readers[count].buffer = &buffers[count * bufferEntities];
+            readers[count].capacity = bufferEntities;
+            readers[count].count = 0;
+            readers[count].place = 0;
+        }
+        ok = mergeGroup(input, output, readers, count, &buffers[fanIn * bufferEntities], bufferEntities);
+    }
+    free(readers);
+    return ok;
+}
+
+/** This function merges some runs into one with a heap of the runs keyed on their next entity.
+ * @param input,            The file of runs.
+ * @param output,           The file to write the merged run to, from where it is now.
+ * @param readers,          The runs.
+ * @param count,            How many runs there are.
+ * @param outBuffer,        A buffer for the output.
+ * @param bufferEntities,   The size of each buffer.
+ * @return,                 1 if it worked, 0 if not.
+ */
+int mergeGroup(int input, int output, struct RunReader* readers, int count, int* outBuffer, size_t bufferEntities)
+{
+    struct RunReader* heap[count];
+    int size = 0;
+    size_t written = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!fillReader(input, &readers[i]))
+        {
+            return 0;
+        }
+        if (readers[i].count > 0)
+        {
+            heap[size++] = &readers[i];
+        }
+    }
+    for (int root = size / 2 - 1; root >= 0; root--)
+    {
+        siftHeap(heap, size, root);
+    }
+
+    while (size > 0)
+    {
+        struct RunReader* top = heap[0];
+
+        outBuffer[written++] = top->buffer[top->place++];
+        if (written == bufferEntities)
+        {
+            if (!writeAll(output, outBuffer, written * sizeof(int)))
+            {
+                return 0;
+            }
+            written = 0;
+        }
+        if (top->place == top->count)
+        {
+            if (!fillReader(input, top))
+            {
+                return 0;
+            }
+            if (top->count == 0)        // Run finished, the last run in the heap takes its place.
+            {
+                heap[0] = heap[--size];
+            }
+        }
+        if (size > 0)
+        {
+            siftHeap(heap, size, 0);
+        }
+    }
+    return writeAll(output, outBuffer, written * sizeof(int));
+}
+
+/** This function reads the next buffer of a run.
+ * @param input,    The file of runs.
+ * @param reader,   The run, its count is set to 0 once it is finished.
+ * @return,         1 if it worked, 0 if the read failed.
+ */
+int fillReader(int input, struct RunReader* reader)
+{
+    long long left = reader->end - reader->next;
+    size_t count = (left < (long long)reader->capacity) ? (size_t)left : reader->capacity;
+
+    if (!readAll(input, reader->buffer, count * sizeof(int), (off_t)(reader->next * sizeof(int))))
+    {
+        return 0;
+    }
+    reader->next += (long long)count;
+    reader->count = count;
+    reader->place = 0;
+    return 1;
+}
+
+/** This function moves a run down the merge heap until the runs below it have larger next entities.
+ * @param heap, The runs, keyed on the next entity in each one's buffer.
+ * @param size, The number of runs in the heap.
+ * @param root, The place in the heap of the run being moved.
+ */
+void siftHeap(struct RunReader** heap, int size, int root)
+{
+    struct RunReader* reader = heap[root];
+    int value = reader->buffer[reader->place];
+    int child = 2 * root + 1;
+
+    while (child < size)
+    {
+        if (child + 1 < size && heap[child + 1]->buffer[heap[child + 1]->place] < heap[child]->buffer[heap[child]->place])
+        {
+            child++;
+        }
+        if (value <= heap[child]->buffer[heap[child]->place])
+        {
+            break;
+        }
+        heap[root] = heap[child];
+        root = child;
+        child = 2 * root + 1;
+    }
+    heap[root] = reader;
+}
+
+/** This function makes a temporary file and deletes its name straight away, so it goes when it is closed.
+ * @param directory,    The directory to make it in, NULL for the directory of outputName.
+ * @param outputName,   The output file's name.
+ * @return,             The open file, or -1 if it couldn't be made.
+ */
+int makeTempFile(const char* directory, const char* outputName)
+{
+    size_t length;
+    char* name;
+    int file;
+
+    if (directory != NULL)
+    {
+        length = strlen(directory);
+    }
+    else
+    {
+        const char* slash = strrchr(outputName, '/');
+        if (slash == NULL)
+        {
+            directory = ".";
+            length = 1;
+        }
+        else
+        {
+            directory = outputName;
+            length = (slash == outputName) ? 1 : (size_t)(slash - outputName);
+        }
+    }
+    name = malloc(length + sizeof(TEMP_NAME) + 1);
+    if (name == NULL)
+    {
+        return -1;
+    }
+    memcpy(name, directory, length);
+    name[length] = '/';
+    memcpy(&name[length + 1], TEMP_NAME, sizeof(TEMP_NAME));
+    file = mkstemp(name);
+    if (file >= 0)
+    {
+        unlink(name);
+    }
+    free(name);
+    return file;
+}
+
+/** This function reads a whole block of a file from a place in it, however many reads that takes.
+ * @param file,     The file.
+ * @param data,     Where to put what is read.
+ * @param bytes,    How much to read.
+ * @param offset,   Where in the file to read from.
+ * @return,         1 if it was all read, 0 if not.
+ */
+int readAll(int file, void* data, size_t bytes, off_t offset)
+{
+    char* place = data;
+
+    while (bytes > 0)
+    {
+        ssize_t got = pread(file, place, bytes, offset);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            return 0;
+        }
+        place += got;
+        bytes -= (size_t)got;
+        offset += got;
+    }
+    return 1;
+}
+
+/** This function writes a whole block to a file, however many writes that takes.
+ * @param file,     The file.
+ * @param data,     What to write.
+ * @param bytes,    How much to write.
+ * @return,         1 if it was all written, 0 if not.
+ */
+int writeAll(int file, const void* data, size_t bytes)
+{
+    const char* place = data;
+
+    while (bytes > 0)
+    {
+        ssize_t put = write(file, place, bytes);
+        if (put < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (put <= 0)
+        {
+            return 0;
+        }
+        place += put;
+        bytes -= (size_t)put;
+    }
+    return 1;
+}
+
+/** This function reads a clock that only ever goes forwards, in seconds.
+ */
+double sortFileSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
@@ -0,0 +1,29 @@
+/* External merge sort for files of ints too big to sort in memory.
+ * The file is read a chunk at a time through mmap, each chunk is put in a list, sorted there and written out to a
+ * run file, then the runs are merged k at a time with big sequential reads and writes until one is left. Files
+ * are raw native ints, as written by fwrite. Needs mmap, so it is only built on POSIX systems.
+ */
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <stddef.h>
+
+struct List;
+
+struct ExternalSortStats
+/* What an external sort did, for benchmarks */
+{
+    long long entities;
+    int runs;               // Sorted chunks written by the first pass.
+    int mergePasses;        // Passes over the data merging runs, 0 if the file fitted in one chunk.
+    double splitSeconds;    // Reading, sorting and writing the chunks.
+    double mergeSeconds;
+};
+
+int sortFile(const char* inputName, const char* outputName, size_t memoryBytes, const char* tempDirectory,
+             void (*sort)(struct List* list), struct ExternalSortStats* stats);
+/* sorts the ints in one file into another using about memoryBytes of memory, with run files made in tempDirectory
+ * (NULL for the output's directory) and sort used on each chunk (NULL for sortRadix), stats can be NULL,
+ * returns 0 if a file can't be read or written, the output is the input, or there is no memory */
+
+#endif
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "list.h"
+#include "externalSort.h"
+
+/* Benchmark of the external merge sort.
+ * Writes a file of random ints, sorts it with sortFile under each memory limit asked for, and checks the output is
+ * in order and holds the same ints (by count, sum and xor). Run it under a memory cap smaller than the file, for
+ * example "systemd-run --scope -p MemoryMax=256M ExternalSortBench -size 4096 -memory 64,128", to check it really
+ * works out of core. Files go in the working directory unless -dir says otherwise and are deleted after.
+ *
+ * Usage: ExternalSortBench [-o results.csv] [-size MB] [-memory MB,MB,...] [-dir directory] [-seed n]
+ */
+
+// Define constants
+#define DEFAULT_SIZE_MB 1024
+#define DEFAULT_MEMORY_MB "64"
+#define IO_ENTITIES (1 << 20)       // Ints per read or write when making and checking files.
+
+//struct def
+struct FileSummary
+/* What a file of ints holds, to compare the output of a sort with its input */
+{
+    long long count;
+    uint64_t sum;
+    uint64_t xor;
+    int inOrder;
+};
+//end struct def
+
+// Declare hidden functions
+int writeRandomFile(const char* name, long long count, uint64_t* random, struct FileSummary* summary);
+int summariseFile(const char* name, struct FileSummary* summary);
+
+int main(int argc, char* argv[])
+{
+    const char* csvName = NULL;
+    const char* memoryList = DEFAULT_MEMORY_MB;
+    const char* directory = ".";
+    long long sizeMB = DEFAULT_SIZE_MB;
+    uint64_t random = 88172645463325252ull;
+    struct FileSummary input;
+    char inputName[4096];
+    char outputName[4096];
+    FILE* csv = NULL;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-o") == 0) csvName = argv[i + 1];
+        else if (strcmp(argv[i], "-size") == 0) sizeMB = atoll(argv[i + 1]);
+        else if (strcmp(argv[i], "-memory") == 0) memoryList = argv[i + 1];
+        else if (strcmp(argv[i], "-dir") == 0) directory = argv[i + 1];
+        else if (strcmp(argv[i], "-seed") == 0) random = strtoull(argv[i + 1], NULL, 10) * 2 + 1;
+        else
+        {
+            printf("Usage: %s [-o results.csv] [-size MB] [-memory MB,MB,...] [-dir directory] [-seed n]\n", argv[0]);
+            return 1;
+        }
+    }
+    snprintf(inputName, sizeof(inputName), "%s/externalSortInput.bin", directory);
+    snprintf(outputName, sizeof(outputName), "%s/externalSortOutput.bin", directory);
+
+    if (csvName != NULL)
+    {
+        csv = fopen(csvName, "w");
+        if (csv == NULL)
+        {
+            printf("Could not open %s\n", csvName);
+            return 1;
+        }
+        fprintf(csv, "backend,entities,file_mb,memory_mb,runs,merge_passes,split_s,merge_s,total_s,mb_per_s,verified\n");
+    }
+
+    printf("Writing %lld MB of random ints to %s\n", sizeMB, inputName);
+    if (!writeRandomFile(inputName, sizeMB * (1 << 20) / (long long)sizeof(int), &random, &input))
+    {
+        printf("Could not write %s\n", inputName);
+        return 1;
+    }
+    printf("%-8s %12s %8s %10s %6s %7s %10s %10s %10s %8s %9s\n", "backend", "entities", "file_mb", "memory_mb",
+           "runs", "passes", "split_s", "merge_s", "total_s", "mb_per_s", "verified");
+
+    for (const char* memory = memoryList; *memory != '\0'; )
+    {
+        char* end;
+        long long memoryMB = strtoll(memory, &end, 10);
+        struct ExternalSortStats stats;
+        struct FileSummary output;
+        int verified;
+
+        if (end == memory)
+        {
+            break;
+        }
+        memory = (*end == ',') ? end + 1 : end;
+
+        if (!sortFile(inputName, outputName, (size_t)memoryMB << 20, directory, NULL, &stats))
+        {
+            printf("Sorting with %lld MB failed\n", memoryMB);
+            continue;
+        }
+        verified = summariseFile(outputName, &output) && output.inOrder && output.count == input.count &&
+                   output.sum == input.sum && output.xor == input.xor;
+        double total = stats.splitSeconds + stats.mergeSeconds;
+
+        printf("%-8s %12lld %8lld %10lld %6d %7d %10.3f %10.3f %10.3f %8.1f %9d\n", listBackendName(),
+               stats.entities, sizeMB, memoryMB, stats.runs, stats.mergePasses, stats.splitSeconds,
+               stats.mergeSeconds, total, sizeMB / total, verified);
+        if (csv != NULL)
+        {
+            fprintf(csv, "%s,%lld,%lld,%lld,%d,%d,%.6f,%.6f,%.6f,%.3f,%d\n", listBackendName(), stats.entities, sizeMB,
+                    memoryMB, stats.runs, stats.mergePasses, stats.splitSeconds, stats.mergeSeconds, total,
+                    sizeMB / total, verified);
+            fflush(csv);
+        }
+        remove(outputName);
+    }
+
+    remove(inputName);
+    if (csv != NULL)
+    {
+        fclose(csv);
+    }
+    return 0;
+}
+
+/** This function writes a file of random ints.
+ * @param name,     The file to write.
+ * @param count,    How many ints.
+ * @param random,   The xorshift random state.
+ * @param summary,  Filled in with what the file holds.
+ * @return,         1 if it was written, 0 if not.
+ */
+int writeRandomFile(const char* name, long long count, uint64_t* random, struct FileSummary* summary)
+{
+    FILE* file = fopen(name, "wb");
+    int* buffer = malloc(IO_ENTITIES * sizeof(int));
+    int ok = (file != NULL && buffer != NULL);
+
+    memset(summary, 0, sizeof(*summary));
+    for (long long done = 0; done < count && ok; done += IO_ENTITIES)
+    {
+        size_t size = (count - done < IO_ENTITIES) ? (size_t)(count - done) : IO_ENTITIES;
+        for (size_t i = 0; i < size; i++)
+        {
+            *random ^= *random >> 12;
+            *random ^= *random << 25;
+            *random ^= *random >> 27;
+            buffer[i] = (int)((*random * 2685821657736338717ull) >> 32);
+            summary->sum += (uint32_t)buffer[i];
+            summary->xor ^= (uint32_t)buffer[i];
+        }
+        ok = (fwrite(buffer, sizeof(int), size, file) == size);
+    }
+    summary->count = count;
+    free(buffer);
+    if (file != NULL && fclose(file) != 0)
+    {
+        ok = 0;
+    }
+    return ok;
+}
+
+/** This function reads a file of ints through, adding up what it holds and checking it is in order.
+ * @param name,     The file to read.
+ * @param summary,  Filled in with what the file holds.
+ * @return,         1 if it was read, 0 if not.
+ */
+int summariseFile(const char* name, struct FileSummary* summary)
+{
+    FILE* file = fopen(name, "rb");
+    int* buffer = malloc(IO_ENTITIES * sizeof(int));
+    int previous = 0;
+    size_t size;
+
+    memset(summary, 0, sizeof(*summary));
+    summary->inOrder = 1;
+    if (file == NULL || buffer == NULL)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        free(buffer);
+        return 0;
+    }
+    while ((size = fread(buffer, sizeof(int), IO_ENTITIES, file)) > 0)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (summary->count > 0 && buffer[i] < previous)
+            {
+                summary->inOrder = 0;
+            }
+            previous = buffer[i];
+            summary->sum += (uint32_t)buffer[i];
+            summary->xor ^= (uint32_t)buffer[i];
+            summary->count++;
+        }
+    }
+    free(buffer);
+    fclose(file);
+    return 1;
+}
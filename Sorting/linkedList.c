@@ -1,11 +1,38 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef LIST_ALL_BACKENDS
+#define LIST_PREFIX linked
+#endif
 #include "list.h"
+#include "listOps.h"
+
+// Define constants
+#define MERGE_SORT_LEVELS 64        // Pending runs in the merge sort, run i holds 2^i nodes so this covers any list.
+#define SLAB_FIRST_NODES 64         // Nodes in a list's first slab, each slab after that is twice as big...
+#define SLAB_MAX_NODES 65536        // ...up to this many nodes.
+#define SKIP_LEVELS 16              // Levels in the skip list index, each holds about a quarter of the one below.
+
+// Build with LIST_NODE_MALLOC defined to give every node its own malloc instead, to compare against.
 
 // Declare hidden functions
-void partition(struct List* linkedList, struct ListNode* low, struct ListNode* high);
-void quickSort(struct List* linkedList, struct ListNode* low, struct ListNode* high, struct ListNode* prevHigh);
+struct SkipTower;
+struct ListNode* listNodeAlloc(struct List* linkedList, int value);
+struct ListNode* listNodeAllocMany(struct List* linkedList, size_t count);
+void listNodeRelease(struct List* linkedList, struct ListNode* node);
+void linkBefore(struct List* linkedList, struct ListNode* walker, struct ListNode* node);
+void swapWithNext(struct List* linkedList, struct ListNode* node);
+struct ListNode* mergeRuns(struct ListNode* first, struct ListNode* second);
+struct ListNode* takeRun(struct ListNode** node);
+struct ListNode* sortRuns(struct ListNode* first);
+void relinkList(struct List* linkedList, struct ListNode* first);
+int prepareIndex(struct List* linkedList);
+int buildIndex(struct List* linkedList);
+void dropIndex(struct List* linkedList);
+int towerHeight(struct List* linkedList);
+struct ListNode* indexSeek(struct List* linkedList, int entity, int orEqual, int* index,
+                           struct SkipTower** update, int* ranks);
+void indexInsert(struct List* linkedList, struct ListNode* node, int index, struct SkipTower** update, int* ranks);
 
 // struct def
 struct ListNode
@@ -16,6 +43,30 @@ struct ListNode
     struct ListNode* prev;
 };
 
+struct NodeSlab
+/* A block of nodes, handed out in order so nodes added one after another sit next to each other in memory */
+{
+    struct NodeSlab* next;
+    int used;
+    int capacity;
+
+    struct ListNode nodes[];
+};
+
+struct SkipLink
+/* One level of a skip list tower: the next tower that high and how many nodes along the list it is */
+{
+    struct SkipTower* next;
+    int span;
+};
+
+struct SkipTower
+/* A node's entry in the skip list index, about one node in four has one */
+{
+    struct ListNode* node;      // NULL for the index's head tower, which sits just before the first node.
+    struct SkipLink links[];
+};
+
 struct List
 {
     int size;
@@ -23,6 +74,13 @@ struct List
 
     struct ListNode* head;
     struct ListNode* tail;
+
+    struct NodeSlab* slabs;         // Newest slab first, it is the one nodes are taken from.
+    struct ListNode* freeNodes;     // Released nodes, linked through next, reused before the slab.
+
+    struct SkipTower* index;        // Skip list over a sorted list, built by the first search and kept up by ordered
+    int indexLevels;                // inserts. Anything else that changes the list drops it.
+    unsigned int indexRandom;
 };
 //end struct def
 
@@ -49,16 +107,28 @@ struct List* listConstructor()
     struct List* newLinkedList;
 
     newLinkedList = malloc(sizeof(struct List));
+    if (newLinkedList == NULL)
+    {
+        return NULL;
+    }
 
     newLinkedList->size = 0;
+    newLinkedList->isSorted = 1;
     newLinkedList->head = NULL;
     newLinkedList->tail = NULL;
+    newLinkedList->slabs = NULL;
+    newLinkedList->freeNodes = NULL;
+    newLinkedList->index = NULL;
+    newLinkedList->indexLevels = 0;
+    newLinkedList->indexRandom = 2463534242u;
 
     return newLinkedList;
 }
 
 void listDestructor(struct List* linkedList)
 {
+    dropIndex(linkedList);
+#ifdef LIST_NODE_MALLOC
     struct ListNode* currentRecord;
     struct ListNode* nextRecord = linkedList->head;
 
@@ -69,6 +139,17 @@ void listDestructor(struct List* linkedList)
 
         listNodeDestructor(currentRecord);
     }
+#else
+    struct NodeSlab* slab = linkedList->slabs;
+    struct NodeSlab* nextSlab;
+
+    while(slab != NULL)     // Every node lives in a slab, so freeing the slabs frees the lot.
+    {
+        nextSlab = slab->next;
+        free(slab);
+        slab = nextSlab;
+    }
+#endif
 
     free(linkedList);
 }
@@ -76,17 +157,7 @@ void listDestructor(struct List* linkedList)
 int listSize(struct List* linkedList)
 /* Checks size of list*/
 {
-    int size = 0;
-    struct ListNode* currentRecord;
-    struct ListNode* nextRecord = linkedList->head;
-
-    while (nextRecord != NULL)
-    {
-        size ++;
-        currentRecord = nextRecord;
-        nextRecord = currentRecord->next;
-    }
-    return size;
+    return linkedList->size;
 }
 
 int listIsEmpty(struct List* linkedList)
@@ -105,34 +176,268 @@ int listIsEmpty(struct List* linkedList)
 int listAdd(struct List* linkedList, int entity)
 /* Add an entity to a list */
 {
-    struct ListNode* node;
+    struct ListNode* node = listNodeAlloc(linkedList, entity);
 
+    if (node == NULL)
+    {
+        return 0;
+    }
+    dropIndex(linkedList);
     if (listIsEmpty(linkedList))
     {
-        node = listNodeConstructor(entity);
         linkedList->head = node;
         linkedList->tail = node;
         linkedList->size ++;
     }
     else
     {
-        node = listNodeConstructor(entity);
+        if (linkedList->tail->data > entity)
+        {
+            linkedList->isSorted = 0;
+        }
         linkedList->tail->next = node;
         node->prev = linkedList->tail;
         linkedList->tail = node;
         linkedList->size ++;
     }
 
-    if (linkedList->size == listSize(linkedList))
+    return 1;
+}
+
+struct List* listFromArray(const int* array, size_t count)
+/* Makes a list from an array */
+{
+    struct List* linkedList = listConstructor();
+
+    if (linkedList == NULL)
+    {
+        return NULL;
+    }
+    if (!listAppendMany(linkedList, array, count))
+    {
+        listDestructor(linkedList);
+        return NULL;
+    }
+    return linkedList;
+}
+
+int listAppendMany(struct List* linkedList, const int* array, size_t count)
+/* Adds an array of entities to the end of a list */
+{
+    dropIndex(linkedList);
+#ifdef LIST_NODE_MALLOC
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!listAdd(linkedList, array[i]))
+        {
+            return 0;
+        }
+    }
+    return 1;
+#else
+    struct ListNode* nodes;
+    struct ListNode* prev = linkedList->tail;
+
+    if (count == 0)
     {
         return 1;
     }
+    nodes = listNodeAllocMany(linkedList, count);
+    if (nodes == NULL)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++)      // The nodes are side by side, so link them in one pass.
+    {
+        nodes[i].data = array[i];
+        nodes[i].prev = prev;
+        nodes[i].next = &nodes[i + 1];
+        if (prev && prev->data > array[i])
+        {
+            linkedList->isSorted = 0;
+        }
+        prev = &nodes[i];
+    }
+    nodes[count - 1].next = NULL;
+
+    if (linkedList->tail)
+    {
+        linkedList->tail->next = &nodes[0];
+    }
     else
+    {
+        linkedList->head = &nodes[0];
+    }
+    linkedList->tail = &nodes[count - 1];
+    linkedList->size += (int)count;
+    return 1;
+#endif
+}
+
+int listInsert(struct List* linkedList, int index, int entity)
+/* Inserts an entity before the one at index */
+{
+    struct ListNode* walker = linkedList->head;
+    struct ListNode* node;
+
+    if (index < 0 || index > linkedList->size)
+    {
+        return 0;
+    }
+    if (index == linkedList->size)
+    {
+        return listAdd(linkedList, entity);
+    }
+    node = listNodeAlloc(linkedList, entity);
+    if (node == NULL)
     {
         return 0;
     }
+    while (index > 0)
+    {
+        walker = walker->next;
+        index --;
+    }
+    dropIndex(linkedList);
+    linkBefore(linkedList, walker, node);
+    if ((node->prev && node->prev->data > entity) || walker->data < entity)
+    {
+        linkedList->isSorted = 0;
+    }
+    return 1;
 }
 
+int listInsertSorted(struct List* linkedList, int entity)
+/* Inserts an entity into a sorted list, after any equal entities */
+{
+    struct SkipTower* update[SKIP_LEVELS];
+    int ranks[SKIP_LEVELS];
+    struct ListNode* walker;
+    struct ListNode* node;
+    int index;
+
+    prepareIndex(linkedList);
+    walker = indexSeek(linkedList, entity, 1, &index, update, ranks);
+    node = listNodeAlloc(linkedList, entity);
+    if (node == NULL)
+    {
+        return 0;
+    }
+    if (walker)
+    {
+        linkBefore(linkedList, walker, node);
+    }
+    else if (linkedList->tail)
+    {
+        node->prev = linkedList->tail;
+        linkedList->tail->next = node;
+        linkedList->tail = node;
+        linkedList->size ++;
+    }
+    else
+    {
+        linkedList->head = node;
+        linkedList->tail = node;
+        linkedList->size ++;
+    }
+    if (linkedList->index)
+    {
+        indexInsert(linkedList, node, index, update, ranks);
+    }
+    return 1;
+}
+
+int listInsertSortedMany(struct List* linkedList, const int* array, size_t count)
+/* Sorts an array of entities and merges them into a sorted list */
+{
+    struct ListNode start;
+    struct ListNode* last = &start;
+    struct ListNode* node;
+
+    if (!linkedList->isSorted)
+    {
+        sortAdaptive(linkedList);
+    }
+    start.next = NULL;
+    for (size_t i = 0; i < count; i++)      // The batch is chained up on its own first...
+    {
+        node = listNodeAlloc(linkedList, array[i]);
+        if (node == NULL)
+        {
+            while (start.next)
+            {
+                node = start.next;
+                start.next = node->next;
+                listNodeRelease(linkedList, node);
+            }
+            return 0;
+        }
+        last->next = node;
+        last = node;
+    }
+    if (count > 0)
+    {
+        dropIndex(linkedList);
+        if (linkedList->tail)
+        {
+            linkedList->tail->next = NULL;
+        }
+        relinkList(linkedList, mergeRuns(linkedList->head, sortRuns(start.next)));     // ...then sorted and merged in.
+        linkedList->size += (int)count;
+    }
+    return 1;
+}
+
+int listLowerBound(struct List* linkedList, int entity)
+/* Finds the index of the first entity not lower than entity in a sorted list */
+{
+    int index;
+
+    prepareIndex(linkedList);
+    indexSeek(linkedList, entity, 0, &index, NULL, NULL);
+    return index;
+}
+
+int listFind(struct List* linkedList, int entity)
+/* Finds the index of an entity in a sorted list, or -1 if it isn't there */
+{
+    struct ListNode* node;
+    int index;
+
+    prepareIndex(linkedList);
+    node = indexSeek(linkedList, entity, 0, &index, NULL, NULL);
+    return (node && node->data == entity) ? index : -1;
+}
+
+void listToArray(struct List* linkedList, int* array)
+/* Copies a list into an array */
+{
+    struct ListNode* node = linkedList->head;
+    int place = 0;
+
+    while (node != NULL)
+    {
+        array[place] = node->data;
+        place ++;
+        node = node->next;
+    }
+}
+
+const char* listBackendName(void)
+/* Name of this list implementation */
+{
+    return "linked";
+}
+
+const struct ListOps listOps =
+/* This list implementation's functions, for programs that compare it with the others */
+{
+    "linked", listConstructor, listDestructor, listIsEmpty, listSize, listAdd, listFromArray, listAppendMany,
+    listInsert, listToArray, listInsertSorted, listInsertSortedMany, listLowerBound, listFind, sortQuick, sortBubble,
+    sortInsertion, sortMerge, sortAdaptive, sortRadix, sortSimd, sortParallel, sortParallelPool
+};
+
 void listDisplay (struct List* linkedList)
 /* Displays a list*/
 {
@@ -152,190 +457,596 @@ void listDisplay (struct List* linkedList)
 
 int areEqual(struct List* list1, struct List* list2){
     /*will compare two lists to see if they are equal*/
-    int total = 0;
     struct ListNode* listNode1 = list1->head;
     struct ListNode* listNode2 = list2->head;
-    while(total + listNode1){
-        total = 0;
-        total = (listNode1->data == listNode2->data);
+    while(listNode1 && listNode2){
+        if(listNode1->data != listNode2->data){
+            return 0;
+        }
         listNode1 = listNode1->next;
         listNode2 = listNode2->next;
     }
-    return !total;
+    return listNode1 == listNode2;
 }
 
 // Sorting algorithms
 
 /** This function will sort a list using insertion sort.
+ * Each node that is smaller than the one before it is walked back and relinked in front of the first bigger node.
  * @param linkedList,   The linked list to be sorted.
  */
 void sortInsertion(struct List* linkedList){
     struct ListNode* node;
     struct ListNode* nextNode;
     struct ListNode* walker;
-    nextNode = linkedList->head->next;
 
-    do{
-        node = nextNode;
-        walker = linkedList->head;
-        if(walker->data > node->data){
-            if(walker->prev){// not the head
-                nextNode = node->next;
-                node->prev = walker->prev;
-                node->next = walker;
-                walker->prev->next = node;
-                walker->prev = node;
-            }else{// the head
-                nextNode = node->next;
-                node->next = walker;
-                node->prev = NULL;
-                walker->prev = node;
-                linkedList->head = node;
-            }
+    dropIndex(linkedList);
+    if(linkedList->head == NULL){
+        return;
+    }
+    for(node = linkedList->head->next; node; node = nextNode){
+        nextNode = node->next;
+        if(node->prev->data <= node->data){
+            continue;
+        }
+        walker = node->prev;
+        while(walker->prev && walker->prev->data > node->data){
+            walker = walker->prev;
+        }
+        // unlink the node, it can't be the head
+        node->prev->next = node->next;
+        if(node->next){
+            node->next->prev = node->prev;
         }else{
-            if(!walker->next){//the tail
-                nextNode = node->next;
-                node->next = NULL;
-                node->prev = walker;
-                walker->next = node;
-                linkedList->tail = node;
-            }else{
-                walker = walker->next;
-            }
+            linkedList->tail = node->prev;
+        }
+        // link it in in front of walker
+        node->prev = walker->prev;
+        node->next = walker;
+        if(walker->prev){
+            walker->prev->next = node;
+        }else{
+            linkedList->head = node;
         }
-    }while(nextNode);
+        walker->prev = node;
+    }
     linkedList->isSorted = 1;
 }
 
 /** This function sorts a list using bubble sort.
+ * Each pass stops where the previous one last swapped, as everything after that is already in place.
  * @param linkedList,   The linked list to be sorted.
  */
 void sortBubble(struct List* linkedList){
-    struct ListNode* temp = malloc(sizeof(struct ListNode));
-    struct ListNode* node = linkedList->head;
-    struct List listCopy;
+    struct ListNode* node;
+    struct ListNode* end = NULL;
+    int swapped;
 
+    dropIndex(linkedList);
+    if(linkedList->head == NULL){
+        return;
+    }
     do{
-        listCopy = *linkedList;
-        while (node){
+        swapped = 0;
+        node = linkedList->head;
+        while(node->next != end){
             if(node->next->data < node->data){
-                if(node->next->next){
-                    node->prev->next = node->next;
-                    temp->next = node->next->next;
-                    node->next->next = node;
-                    node->next->prev = node->prev;
-                    node->prev = node->next;
-                    node->next = temp->next;
-                    node->next->prev = node;
-                }
+                swapWithNext(linkedList, node);     // node has moved on one place
+                swapped = 1;
+            }else{
+                node = node->next;
             }
-            node = node->next;
         }
-    }while(areEqual(linkedList, &listCopy));
+        end = node;
+    }while(swapped);
     linkedList->isSorted = 1;
 }
 
 /** This function will sort a list using quick sort.
+ * Quick sort needs to step backwards and forwards through a list to partition it, which is slow on a linked
+ * list and quadratic on sorted input, so linked lists are quick sorted with the merge sort instead.
  * @param linkedList,   The linked list to be sorted.
  */
 void sortQuick(struct List* linkedList){
-    struct ListNode* low = linkedList->head;
-    struct ListNode* high = linkedList->tail;
-    high->prev = NULL;
-    quickSort(linkedList, low, high, NULL);
+    sortMerge(linkedList);
+}
+
+/** This function will sort a list using a bottom up merge sort.
+ * Nodes are taken off the front one at a time and merged into a stack of sorted runs like a binary counter,
+ * run i holding 2^i nodes, then the runs are merged together. Nodes are only relinked, using the next pointers,
+ * and the prev pointers and tail are rebuilt in a final pass. Stable, no recursion and no extra memory per node.
+ * @param linkedList,   The linked list to be sorted.
+ */
+void sortMerge(struct List* linkedList){
+    struct ListNode* runs[MERGE_SORT_LEVELS] = {NULL};
+    struct ListNode* node = linkedList->head;
+    struct ListNode* nextNode;
+    struct ListNode* carry;
+    int level;
+
+    dropIndex(linkedList);
+    while(node){
+        nextNode = node->next;
+        node->next = NULL;
+        carry = node;
+        for(level = 0; runs[level]; level++){
+            carry = mergeRuns(runs[level], carry);      // runs[level] holds earlier nodes, keep it first
+            runs[level] = NULL;
+        }
+        runs[level] = carry;
+        node = nextNode;
+    }
+
+    carry = NULL;
+    for(level = 0; level < MERGE_SORT_LEVELS; level++){
+        if(runs[level]){
+            carry = mergeRuns(runs[level], carry);
+        }
+    }
+
+    relinkList(linkedList, carry);
+    linkedList->isSorted = 1;
+}
+
+
+/** This function will sort a list using natural runs, and does nothing if the list is already sorted.
+ * Works like sortMerge, except what is taken off the front each time is a whole ascending run, or a strictly
+ * descending run turned around, instead of one node. O(n) on sorted or nearly sorted lists. Stable.
+ * @param linkedList,   The linked list to be sorted.
+ */
+void sortAdaptive(struct List* linkedList){
+    if(linkedList->isSorted){
+        return;
+    }
+    dropIndex(linkedList);
+    relinkList(linkedList, sortRuns(linkedList->head));
     linkedList->isSorted = 1;
 }
 
+/** This function sorts a list for callers that want the radix sort.
+ * The linked list is sorted with the merge sort, only the array list has a radix sort.
+ * @param linkedList,   The linked list to be sorted.
+ */
+void sortRadix(struct List* linkedList)
+{
+    sortMerge(linkedList);
+}
+
+/** This function sorts a list for callers that want the vectorised sort.
+ * The linked list is sorted with the merge sort, only the array list has a vectorised sort.
+ * @param linkedList,   The linked list to be sorted.
+ */
+void sortSimd(struct List* linkedList)
+{
+    sortMerge(linkedList);
+}
+
+/** This function sorts a list for callers that want a parallel sort.
+ * The linked list is sorted with the merge sort on the calling thread, only the array list splits sorts across threads.
+ * @param linkedList,   The linked list to be sorted.
+ * @param threads,      Ignored.
+ */
+void sortParallel(struct List* linkedList, int threads)
+{
+    (void)threads;
+    sortMerge(linkedList);
+}
+
+/** This function sorts a list for callers that want a parallel sort on their own pool.
+ * The linked list is sorted with the merge sort on the calling thread, as sortParallel does.
+ * @param linkedList,   The linked list to be sorted.
+ * @param pool,         Ignored.
+ */
+void sortParallelPool(struct List* linkedList, struct ThreadPool* pool)
+{
+    (void)pool;
+    sortMerge(linkedList);
+}
 
 // Hidden functions
 
-/** This function is the recursive part of the quick sort algorithm
- * @param linkedList,   The linked list being sorted.
- * @param low,          The low limit of the section of the list being sorted
- * @param high,         The high limit of the section of the list being sorted
+/** This function gives a list a new node, from its free nodes if it has any, otherwise from its newest slab.
+ * @param linkedList,   The linked list the node is for.
+ * @param value,        The data for the node.
+ * @return,             The node, unlinked, or NULL if there is no memory left.
  */
-void quickSort(struct List* linkedList, struct ListNode* low, struct ListNode* high, struct ListNode* prevHigh)
-{
-    printf("new \n");
-    /*if (high->data > low->data)
-    {*/
-        if(high){
-            partition (linkedList, low, high);
-            if(high->prev){
-            printf("here 1");
-                quickSort(linkedList, low, high->prev, high);
-            }
-            if(prevHigh){
-            printf("here 2");
-                quickSort(linkedList, high, prevHigh->prev, prevHigh);
-            }else{
-            printf("here 3");
-            //printf("%p, %p, %p \n", high, linkedList->tail, prevHigh);
-                quickSort(linkedList, high, linkedList->tail, prevHigh);
-            }
+struct ListNode* listNodeAlloc(struct List* linkedList, int value)
+{
+#ifdef LIST_NODE_MALLOC
+    (void)linkedList;
+    return listNodeConstructor(value);
+#else
+    struct ListNode* node = linkedList->freeNodes;
+
+    if(node){
+        linkedList->freeNodes = node->next;
+    }else{
+        node = listNodeAllocMany(linkedList, 1);
+        if(node == NULL){
+            return NULL;
         }
-    //}
+    }
+    node->data = value;
+    node->next = NULL;
+    node->prev = NULL;
+    return node;
+#endif
 }
 
-/**
- * @param linkedList,   The linked list being sorted.
- * @param low,          The low limit of the section of the list being sorted
- * @param high,         The high limit of the section of the list being sorted
+/** This function gives a list a run of nodes side by side in memory, from the newest slab if it has room, otherwise
+ * from a new slab big enough for them all.
+ * @param linkedList,   The linked list the nodes are for.
+ * @param count,        How many nodes are wanted.
+ * @return,             The first node, unlinked and uninitialised, or NULL if there is no memory left.
  */
-void partition(struct List* linkedList, struct ListNode* low, struct ListNode* high)
+struct ListNode* listNodeAllocMany(struct List* linkedList, size_t count)
 {
-    struct ListNode* walker;
-    struct ListNode* nextWalker;
-    struct ListNode* temp;
-    if(low == NULL){
-        walker = linkedList->head;
+    struct NodeSlab* slab = linkedList->slabs;
+    size_t capacity;
+
+    if(slab == NULL || (size_t)(slab->capacity - slab->used) < count){
+        capacity = slab ? (size_t)slab->capacity * 2 : SLAB_FIRST_NODES;
+        if(capacity > SLAB_MAX_NODES){
+            capacity = SLAB_MAX_NODES;
+        }
+        if(capacity < count){
+            capacity = count;
+        }
+        if(capacity > (size_t)0x7fffffff){
+            return NULL;
+        }
+        slab = malloc(sizeof(struct NodeSlab) + capacity * sizeof(struct ListNode));
+        if(slab == NULL){
+            return NULL;
+        }
+        slab->next = linkedList->slabs;
+        slab->used = 0;
+        slab->capacity = (int)capacity;
+        linkedList->slabs = slab;
+    }
+    slab->used += (int)count;
+    return &slab->nodes[slab->used - count];
+}
+
+/** This function hands a node that has been unlinked back to its list to be reused.
+ * @param linkedList,   The linked list the node came from.
+ * @param node,         The node, no longer linked into the list.
+ */
+void listNodeRelease(struct List* linkedList, struct ListNode* node)
+{
+#ifdef LIST_NODE_MALLOC
+    (void)linkedList;
+    listNodeDestructor(node);
+#else
+    node->next = linkedList->freeNodes;
+    linkedList->freeNodes = node;
+#endif
+}
+
+/** This function links a new node into a list in front of another.
+ * @param linkedList,   The linked list.
+ * @param walker,       The node already in the list.
+ * @param node,         The new node to go in front of it.
+ */
+void linkBefore(struct List* linkedList, struct ListNode* walker, struct ListNode* node)
+{
+    node->prev = walker->prev;
+    node->next = walker;
+    if(walker->prev){
+        walker->prev->next = node;
     }else{
-        walker = low->next;
-    }
-    printf("current %d, %p, next-%p, prev-%p\n", high->data, high, high->next, high->prev);
-    while(walker != high){
-        nextWalker = walker->next;
-        //printf("walker %d, prev-%p, next-%p, address-%p\n", walker->data, walker->prev, walker->next, walker);
-        if(walker->data < high->data){//less than
-            printf("lower \n");
-            if(high->prev == NULL){
-                linkedList->head = walker;
-            }else{
-                high->prev->next = walker;
+        linkedList->head = node;
+    }
+    walker->prev = node;
+    linkedList->size ++;
+}
+
+/** This function swaps a node with the one after it.
+ * @param linkedList,   The linked list containing the nodes.
+ * @param node,         The node to move back one place, it must have a next node.
+ */
+void swapWithNext(struct List* linkedList, struct ListNode* node)
+{
+    struct ListNode* nextNode = node->next;
+
+    node->next = nextNode->next;
+    if(nextNode->next){
+        nextNode->next->prev = node;
+    }else{
+        linkedList->tail = node;
+    }
+    nextNode->prev = node->prev;
+    if(node->prev){
+        node->prev->next = nextNode;
+    }else{
+        linkedList->head = nextNode;
+    }
+    nextNode->next = node;
+    node->prev = nextNode;
+}
+
+/** This function merges two sorted runs linked through their next pointers.
+ * On equal values nodes from the first run go first, which keeps the merge sort stable.
+ * @param first,    The run of nodes that came first in the list.
+ * @param second,   The run of nodes that came after them.
+ * @return,         The first node of the merged run.
+ */
+struct ListNode* mergeRuns(struct ListNode* first, struct ListNode* second)
+{
+    struct ListNode start;
+    struct ListNode* tail = &start;
+
+    while(first && second){
+        if(second->data < first->data){
+            tail->next = second;
+            second = second->next;
+        }else{
+            tail->next = first;
+            first = first->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = first ? first : second;
+    return start.next;
+}
+
+/** This function cuts the run starting at a node off the rest of the list, reversing it if it is strictly descending.
+ * @param node, The first node of the run, moved on to the first node after it.
+ * @return,     The first node of the run, now ascending and ended with a NULL next pointer.
+ */
+struct ListNode* takeRun(struct ListNode** node)
+{
+    struct ListNode* run = *node;
+    struct ListNode* last = run;
+    struct ListNode* next = run->next;
+
+    if(next && next->data < run->data){
+        run->next = NULL;
+        while(next && next->data < run->data){      // Each node goes on the front, turning the run around.
+            struct ListNode* after = next->next;
+            next->next = run;
+            run = next;
+            next = after;
+        }
+    }else{
+        while(next && next->data >= last->data){
+            last = next;
+            next = next->next;
+        }
+        last->next = NULL;
+    }
+    *node = next;
+    return run;
+}
+
+/** This function sorts nodes linked through their next pointers by merging their natural runs, like sortMerge merges
+ * single nodes: runs go into a stack like a binary counter and the stack is merged together at the end.
+ * @param first,    The first node, the last has a NULL next pointer.
+ * @return,         The first node once sorted, only the next pointers are set.
+ */
+struct ListNode* sortRuns(struct ListNode* first)
+{
+    struct ListNode* runs[MERGE_SORT_LEVELS] = {NULL};
+    struct ListNode* carry;
+    int level;
+
+    while(first){
+        carry = takeRun(&first);
+        for(level = 0; runs[level]; level++){
+            carry = mergeRuns(runs[level], carry);
+            runs[level] = NULL;
+        }
+        runs[level] = carry;
+    }
+
+    carry = NULL;
+    for(level = 0; level < MERGE_SORT_LEVELS; level++){
+        if(runs[level]){
+            carry = mergeRuns(runs[level], carry);
+        }
+    }
+    return carry;
+}
+
+/** This function makes a chain of nodes linked through their next pointers the list's nodes, setting the prev
+ * pointers, head and tail to match.
+ * @param linkedList,   The linked list.
+ * @param first,        The first node of the chain.
+ */
+void relinkList(struct List* linkedList, struct ListNode* first)
+{
+    struct ListNode* prev = NULL;
+
+    linkedList->head = first;
+    for(; first; first = first->next){
+        first->prev = prev;
+        prev = first;
+    }
+    linkedList->tail = prev;
+}
+
+/** This function gets a list ready to be searched: sorted, and with a skip list index if there is memory for one.
+ * @param linkedList,   The linked list.
+ * @return,             1 if the list has an index, 0 if searches will have to walk the list.
+ */
+int prepareIndex(struct List* linkedList)
+{
+    if(!linkedList->isSorted){
+        sortAdaptive(linkedList);
+    }
+    if(linkedList->index == NULL){
+        return buildIndex(linkedList);
+    }
+    return 1;
+}
+
+/** This function builds the skip list index over a sorted list in one pass, giving each node a random height.
+ * @param linkedList,   The linked list.
+ * @return,             1 if it was built, 0 if there was no memory for it.
+ */
+int buildIndex(struct List* linkedList)
+{
+    struct SkipTower* last[SKIP_LEVELS];
+    int lastRanks[SKIP_LEVELS];
+    struct SkipTower* head = malloc(sizeof(struct SkipTower) + SKIP_LEVELS * sizeof(struct SkipLink));
+    struct ListNode* node;
+    int rank = 0;
+
+    if(head == NULL){
+        return 0;
+    }
+    head->node = NULL;
+    linkedList->index = head;
+    linkedList->indexLevels = 1;
+    for(int level = 0; level < SKIP_LEVELS; level++){
+        head->links[level].next = NULL;
+        last[level] = head;
+        lastRanks[level] = -1;
+    }
+
+    for(node = linkedList->head; node; node = node->next, rank++){
+        int height = towerHeight(linkedList);
+        if(height == 0){
+            continue;
+        }
+        struct SkipTower* tower = malloc(sizeof(struct SkipTower) + height * sizeof(struct SkipLink));
+        if(tower == NULL){
+            for(int level = 0; level < SKIP_LEVELS; level++){
+                last[level]->links[level].span = linkedList->size - lastRanks[level];
             }
-            walker->prev = high->prev;
-            walker->next = high;
-            high->prev = walker;
-        }else{//greater than or equal to high
-            printf("higher \n");
-            if(high->next == NULL){
-                linkedList->tail = walker;
+            dropIndex(linkedList);
+            return 0;
+        }
+        tower->node = node;
+        for(int level = 0; level < height; level++){
+            tower->links[level].next = NULL;
+            last[level]->links[level].next = tower;
+            last[level]->links[level].span = rank - lastRanks[level];
+            last[level] = tower;
+            lastRanks[level] = rank;
+        }
+        if(height > linkedList->indexLevels){
+            linkedList->indexLevels = height;
+        }
+    }
+    for(int level = 0; level < SKIP_LEVELS; level++){      // The last link of each level spans to the end of the list.
+        last[level]->links[level].span = linkedList->size - lastRanks[level];
+    }
+    return 1;
+}
+
+/** This function frees a list's skip list index, if it has one.
+ * @param linkedList,   The linked list.
+ */
+void dropIndex(struct List* linkedList)
+{
+    struct SkipTower* tower = linkedList->index;
+    struct SkipTower* next;
+
+    while(tower){       // Every tower is on the bottom level.
+        next = tower->links[0].next;
+        free(tower);
+        tower = next;
+    }
+    linkedList->index = NULL;
+    linkedList->indexLevels = 0;
+}
+
+/** This function picks a random tower height for a node, 0 three times in four, then each level a quarter as likely.
+ * @param linkedList,   The linked list, whose random state is used.
+ */
+int towerHeight(struct List* linkedList)
+{
+    unsigned int random = linkedList->indexRandom;
+    int height = 0;
+
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    linkedList->indexRandom = random;
+    while((random & 3) == 0 && height < SKIP_LEVELS){
+        height++;
+        random >>= 2;
+    }
+    return height;
+}
+
+/** This function finds where an entity goes in a sorted list, going down the index then along the nodes.
+ * Without an index it walks the list from the start.
+ * @param linkedList,   The sorted linked list.
+ * @param entity,       The value being looked for.
+ * @param orEqual,      0 to stop before entities equal to it, 1 to go past them.
+ * @param index,        Set to the index of the node returned, or the list size.
+ * @param update,       If not NULL, set to the last tower before that place on each level, for indexInsert.
+ * @param ranks,        If not NULL, set to the indexes of those towers' nodes, -1 for the head tower.
+ * @return,             The first node not lower than the entity (greater if orEqual), or NULL if there is none.
+ */
+struct ListNode* indexSeek(struct List* linkedList, int entity, int orEqual, int* index,
+                           struct SkipTower** update, int* ranks)
+{
+    struct SkipTower* tower = linkedList->index;
+    struct ListNode* node;
+    int rank = -1;
+
+    if(tower){
+        for(int level = SKIP_LEVELS - 1; level >= 0; level--){
+            if(level < linkedList->indexLevels){
+                struct SkipTower* next = tower->links[level].next;
+                while(next && (next->node->data < entity || (orEqual && next->node->data == entity))){
+                    rank += tower->links[level].span;
+                    tower = next;
+                    next = tower->links[level].next;
+                }
             }
-            walker->next = high->next;
-            walker->prev = high;
-            if(walker->next){
-                printf("here");
-                walker->next->prev = walker;
+            if(update){
+                update[level] = tower;
+                ranks[level] = rank;
             }
-            high->next = walker;
         }
-        printf("walker %d, prev-%p, next-%p, address-%p\n", walker->data, walker->prev, walker->next, walker);
-        walker = nextWalker;
-    }
-    if(!high->next){
-            printf("hacked");
-        linkedList->tail = high;
-    }
-    //printf("prev? %p, next %p, address %p\n", linkedList->head->prev, linkedList->head->next, linkedList->head);
-    if(!high->prev){
-        printf("hacked");
-        linkedList->head = high;
-    }
-    printf("head data %d, tail data %d\n", linkedList->head->data, linkedList->tail->data);
-    walker = linkedList->head;
-    while(walker){
-        printf("%d ", walker->data);
-        walker = walker->next;
     }
-    printf("end");
+    node = (tower && tower->node) ? tower->node->next : linkedList->head;
+    rank++;
+    while(node && (node->data < entity || (orEqual && node->data == entity))){
+        node = node->next;
+        rank++;
+    }
+    *index = rank;
+    return node;
+}
+
+/** This function adds a node just linked into a sorted list to its index, giving it a tower if it gets one and
+ * widening the links that now pass over one more node.
+ * @param linkedList,   The linked list, with an index.
+ * @param node,         The new node.
+ * @param index,        Its index in the list.
+ * @param update,       The last tower before it on each level, from indexSeek.
+ * @param ranks,        The indexes of those towers' nodes, from indexSeek.
+ */
+void indexInsert(struct List* linkedList, struct ListNode* node, int index, struct SkipTower** update, int* ranks)
+{
+    int height = towerHeight(linkedList);
+    struct SkipTower* tower = NULL;
+
+    if(height > 0){
+        tower = malloc(sizeof(struct SkipTower) + height * sizeof(struct SkipLink));
+        if(tower == NULL){
+            dropIndex(linkedList);      // The next search builds it again.
+            return;
+        }
+        tower->node = node;
+        if(height > linkedList->indexLevels){
+            linkedList->indexLevels = height;
+        }
+    }
+    for(int level = 0; level < SKIP_LEVELS; level++){
+        struct SkipLink* link = &update[level]->links[level];
+        if(level < height){
+            tower->links[level].next = link->next;
+            tower->links[level].span = link->span - (index - ranks[level]) + 1;
+            link->next = tower;
+            link->span = index - ranks[level];
+        }else{
+            link->span++;
+        }
+    }
 }
@@ -1,13 +1,53 @@
+#include <stddef.h>
+#ifdef LIST_PREFIX
+#include "listPrefix.h"
+#endif
 
 
+
+struct ThreadPool;
+
 struct ListNode* listNodeConstructor(int value);
 void listNodeDestructor(struct ListNode* node);
 struct List* listConstructor();
+/* makes a new empty list, or returns NULL if there is no memory */
 void listDestructor(struct List* linkedList);
 int listIsEmpty(struct List* linkedList);
 int listSize(struct List* linkedList);
 int areEqual(struct List* list1, struct List* list2);
 int listAdd(struct List* linkedList, int entity);
+/* adds an entity to the end of a list, returns 0 if there is no memory */
+struct List* listFromArray(const int* array, size_t count);
+/* makes a new list holding count entities from an array, in order, or returns NULL if there is no memory */
+int listAppendMany(struct List* list, const int* array, size_t count);
+/* adds count entities from an array to the end of a list in one go, returns 0 if there is no memory */
+int listInsert(struct List* list, int index, int entity);
+/* inserts an entity before the one at index (index == size appends), returns 0 if index is out of range or there is no memory */
+void listToArray(struct List* list, int* array);
+/* copies every entity of a list into an array big enough to hold them, in list order */
+const char* listBackendName(void);
+/* name of the list implementation this was built with */
+
+// Sorted lists
+// Each of these sorts the list first if it isn't already sorted.
+
+int listInsertSorted(struct List* list, int entity);
+/* inserts an entity into a sorted list after any equal entities, returns 0 if there is no memory */
+int listInsertSortedMany(struct List* list, const int* array, size_t count);
+/* sorts count entities from an array and merges them into a sorted list in one pass, returns 0 if there is no memory */
+int listLowerBound(struct List* list, int entity);
+/* index of the first entity in a sorted list that is not lower than entity, the list size if there is none */
+int listFind(struct List* list, int entity);
+/* index of the first entity in a sorted list equal to entity, or -1 if there is none */
+
+// Array list capacity
+
+int listReserve(struct List* list, size_t capacity);
+/* makes room for at least capacity entities so appends up to that size never reallocate, returns 0 if there is no memory */
+void listShrinkToFit(struct List* list);
+/* gives back any room beyond the entities in the list */
+void listSetGrowthFactor(struct List* list, double factor);
+/* sets how much the capacity is multiplied by when the list fills up, 2 by default */
 
 // Sorting functions
 
@@ -19,3 +59,21 @@ void sortBubble(struct List* list);
 
 void sortInsertion(struct List* list);
 /* sorts a list using insertion sort*/
+
+void sortMerge(struct List* list);
+/* sorts a list using a stable merge sort */
+
+void sortAdaptive(struct List* list);
+/* sorts a list by merging the runs already in it, does nothing if the list is already sorted */
+
+void sortRadix(struct List* list);
+/* sorts a list using a least significant digit radix sort */
+
+void sortSimd(struct List* list);
+/* sorts a list using quick sort vectorised with AVX2 where the CPU has it */
+
+void sortParallel(struct List* list, int threads);
+/* sorts a list using that many threads, 0 or less for one per core, on a pool started and stopped for this sort */
+
+void sortParallelPool(struct List* list, struct ThreadPool* pool);
+/* sorts a list on a pool from poolConstructor, for callers sorting many lists. One sort at a time per pool */
@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "listOps.h"
+
+/* Benchmark of the list itself rather than its sorts.
+ * Times building a list of random values one listAdd at a time and all at once with listFromArray, walking it into
+ * an array, inserting into the middle of it, sorting it, and inserting into and searching the sorted list, for list
+ * sizes going up by powers of ten. Build it against one list implementation (or the linked list with
+ * LIST_NODE_MALLOC defined for one malloc per node), or with LIST_ALL_BACKENDS defined and every list implementation
+ * compiled in to run the same workload on each of them, taking turns within each trial. Times are the median over
+ * the trials, the middle insert, sorted insert and find times are for one call. The sorted list is searched once
+ * before they are timed, so the linked list's index is already built.
+ *
+ * Usage: ListBench [-o bench.csv] [-max n] [-trials n] [-budget seconds]
+ */
+
+// Define constants
+#define DEFAULT_MAX_SIZE 10000000
+#define DEFAULT_TRIALS 5
+#define DEFAULT_BUDGET 10.0         // Seconds, stop growing the list once one round takes longer than this.
+#define MIDDLE_INSERTS 100
+
+enum Operation { BUILD, BULK_BUILD, TRAVERSE, MIDDLE_INSERT, SORT_QUICK, SORT_MERGE, SORTED_INSERT, FIND,
+                 NUM_OPERATIONS };
+
+static const char* operationNames[NUM_OPERATIONS] =
+{
+    "build", "bulk_build", "traverse", "middle_insert", "sort_quick", "sort_merge", "sorted_insert", "find"
+};
+
+static const struct ListOps* backends[] = LIST_BACKENDS;
+
+#define NUM_BACKENDS ((int)(sizeof(backends) / sizeof(backends[0])))
+
+// Declare hidden functions
+double runTrial(const struct ListOps* ops, const int* values, int n, int* out, double* times[NUM_OPERATIONS],
+                int trial);
+double monotonicSeconds(void);
+int compareDoubles(const void* a, const void* b);
+
+int main(int argc, char* argv[])
+{
+    const char* csvName = NULL;
+    long long maxSize = DEFAULT_MAX_SIZE;
+    int trials = DEFAULT_TRIALS;
+    double budget = DEFAULT_BUDGET;
+    uint64_t random = 88172645463325252ull;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-o") == 0) csvName = argv[i + 1];
+        else if (strcmp(argv[i], "-max") == 0) maxSize = atoll(argv[i + 1]);
+        else if (strcmp(argv[i], "-trials") == 0) trials = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-budget") == 0) budget = atof(argv[i + 1]);
+    }
+    if (trials < 1)
+    {
+        trials = 1;
+    }
+
+    FILE* csv = NULL;
+    if (csvName != NULL)
+    {
+        csv = fopen(csvName, "w");
+        if (csv == NULL)
+        {
+            printf("Could not open %s\n", csvName);
+            return 1;
+        }
+        fprintf(csv, "backend,size");
+        for (int op = 0; op < NUM_OPERATIONS; op++)
+        {
+            fprintf(csv, ",%s_s", operationNames[op]);
+        }
+        fprintf(csv, "\n");
+    }
+
+    double* times[NUM_BACKENDS][NUM_OPERATIONS];
+    for (int backend = 0; backend < NUM_BACKENDS; backend++)
+    {
+        for (int op = 0; op < NUM_OPERATIONS; op++)
+        {
+            times[backend][op] = malloc(trials * sizeof(double));
+        }
+    }
+    printf("%-8s %10s", "backend", "size");
+    for (int op = 0; op < NUM_OPERATIONS; op++)
+    {
+        printf(" %13s", operationNames[op]);
+    }
+    printf("\n");
+
+    for (long long size = 1000; size <= maxSize; size *= 10)
+    {
+        int n = (int)size;
+        int* values = malloc(n * sizeof(int));
+        int* out = malloc(n * sizeof(int));
+        if (values == NULL || out == NULL)
+        {
+            printf("Out of memory at %d elements\n", n);
+            free(values);
+            free(out);
+            break;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            random ^= random >> 12;
+            random ^= random << 25;
+            random ^= random >> 27;
+            values[i] = (int)((random * 2685821657736338717ull) >> 32);
+        }
+
+        double round = 0;
+        for (int trial = 0; trial < trials; trial++)
+        {
+            round = 0;
+            for (int backend = 0; backend < NUM_BACKENDS; backend++)
+            {
+                round += runTrial(backends[backend], values, n, out, times[backend], trial);
+            }
+        }
+
+        for (int backend = 0; backend < NUM_BACKENDS; backend++)
+        {
+            printf("%-8s %10d", backends[backend]->name, n);
+            if (csv != NULL)
+            {
+                fprintf(csv, "%s,%d", backends[backend]->name, n);
+            }
+            for (int op = 0; op < NUM_OPERATIONS; op++)
+            {
+                qsort(times[backend][op], trials, sizeof(double), compareDoubles);
+                printf(" %13.9f", times[backend][op][trials / 2]);
+                if (csv != NULL)
+                {
+                    fprintf(csv, ",%.9f", times[backend][op][trials / 2]);
+                }
+            }
+            printf("\n");
+            if (csv != NULL)
+            {
+                fprintf(csv, "\n");
+                fflush(csv);
+            }
+        }
+        free(values);
+        free(out);
+        if (round > budget)
+        {
+            break;
+        }
+    }
+    for (int backend = 0; backend < NUM_BACKENDS; backend++)
+    {
+        for (int op = 0; op < NUM_OPERATIONS; op++)
+        {
+            free(times[backend][op]);
+        }
+    }
+    if (csv != NULL)
+    {
+        fclose(csv);
+    }
+    return 0;
+}
+
+/** This function runs every operation once on one list implementation.
+ * @param ops,      The list implementation.
+ * @param values,   The random values to fill the list with.
+ * @param n,        How many values.
+ * @param out,      Room for n ints to walk the list into.
+ * @param times,    The times for each operation, this trial's go at them is filled in.
+ * @param trial,    Which trial this is.
+ * @return,         How long the whole trial took, in seconds.
+ */
+double runTrial(const struct ListOps* ops, const int* values, int n, int* out, double* times[NUM_OPERATIONS],
+                int trial)
+{
+    double start = monotonicSeconds();
+    struct List* list = ops->constructor();
+    for (int i = 0; i < n; i++)
+    {
+        ops->add(list, values[i]);
+    }
+    double built = monotonicSeconds();
+    ops->toArray(list, out);
+    double walked = monotonicSeconds();
+    for (int i = 0; i < MIDDLE_INSERTS; i++)
+    {
+        ops->insert(list, ops->size(list) / 2, values[i]);
+    }
+    double inserted = monotonicSeconds();
+    ops->quick(list);
+    double quickSorted = monotonicSeconds();
+    ops->destructor(list);
+
+    double freed = monotonicSeconds();      // Freeing the first list isn't part of any operation.
+    list = ops->fromArray(values, n);
+    double bulkBuilt = monotonicSeconds();
+    ops->merge(list);
+    double mergeSorted = monotonicSeconds();
+    ops->find(list, values[0]);
+    double indexed = monotonicSeconds();
+    for (int i = 0; i < MIDDLE_INSERTS; i++)
+    {
+        ops->insertSorted(list, values[n - 1 - i]);
+    }
+    double sortedInserted = monotonicSeconds();
+    for (int i = 0; i < MIDDLE_INSERTS; i++)
+    {
+        ops->find(list, values[(i * 7919) % n]);
+    }
+    double found = monotonicSeconds();
+    ops->destructor(list);
+
+    times[BUILD][trial] = built - start;
+    times[TRAVERSE][trial] = walked - built;
+    times[MIDDLE_INSERT][trial] = (inserted - walked) / MIDDLE_INSERTS;
+    times[SORT_QUICK][trial] = quickSorted - inserted;
+    times[BULK_BUILD][trial] = bulkBuilt - freed;
+    times[SORT_MERGE][trial] = mergeSorted - bulkBuilt;
+    times[SORTED_INSERT][trial] = (sortedInserted - indexed) / MIDDLE_INSERTS;
+    times[FIND][trial] = (found - sortedInserted) / MIDDLE_INSERTS;
+    return found - start;
+}
+
+/** This function reads a clock that only ever goes forwards, in seconds.
+ */
+double monotonicSeconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+int compareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,55 @@
+/* A table of one list implementation's functions, so a program can run the same code against any of them.
+ * Built normally, only listOps exists and holds the functions list.h declares. Built with LIST_ALL_BACKENDS defined
+ * and every list implementation compiled in, each one's functions get its own prefix (see listPrefix.h) and its
+ * table is named after it, so LIST_BACKENDS lists them all.
+ */
+#ifndef LIST_OPS_H
+#define LIST_OPS_H
+
+#include <stddef.h>
+
+struct List;
+struct ThreadPool;
+
+struct ListOps
+/* The functions of one list implementation, named as in list.h without the list or sort */
+{
+    const char* name;
+    struct List* (*constructor)(void);
+    void (*destructor)(struct List* list);
+    int (*isEmpty)(struct List* list);
+    int (*size)(struct List* list);
+    int (*add)(struct List* list, int entity);
+    struct List* (*fromArray)(const int* array, size_t count);
+    int (*appendMany)(struct List* list, const int* array, size_t count);
+    int (*insert)(struct List* list, int index, int entity);
+    void (*toArray)(struct List* list, int* array);
+    int (*insertSorted)(struct List* list, int entity);
+    int (*insertSortedMany)(struct List* list, const int* array, size_t count);
+    int (*lowerBound)(struct List* list, int entity);
+    int (*find)(struct List* list, int entity);
+    void (*quick)(struct List* list);
+    void (*bubble)(struct List* list);
+    void (*insertion)(struct List* list);
+    void (*merge)(struct List* list);
+    void (*adaptive)(struct List* list);
+    void (*radix)(struct List* list);
+    void (*simd)(struct List* list);
+    void (*parallel)(struct List* list, int threads);
+    void (*parallelPool)(struct List* list, struct ThreadPool* pool);
+};
+
+extern const struct ListOps listOps;
+/* the list implementation this was built with */
+
+#ifdef LIST_ALL_BACKENDS
+extern const struct ListOps array_listOps;
+extern const struct ListOps linked_listOps;
+extern const struct ListOps unrolled_listOps;
+#define LIST_BACKENDS { &array_listOps, &linked_listOps, &unrolled_listOps }
+#else
+#define LIST_BACKENDS { &listOps }
+#endif
+/* initialiser for an array of every list implementation built in */
+
+#endif
@@ -0,0 +1,38 @@
+/* Renames the list.h functions with a prefix for the list implementation being compiled, so more than one can be
+ * linked into the same program. A list implementation sets LIST_PREFIX before including list.h when
+ * LIST_ALL_BACKENDS is defined, and the program then reaches each one through its table in listOps.h.
+ * Functions only one implementation defines are left alone.
+ */
+#ifndef LIST_PREFIX_H
+#define LIST_PREFIX_H
+
+#define LIST_JOIN(prefix, name) prefix##_##name
+#define LIST_NAME(prefix, name) LIST_JOIN(prefix, name)
+
+#define listConstructor LIST_NAME(LIST_PREFIX, listConstructor)
+#define listDestructor LIST_NAME(LIST_PREFIX, listDestructor)
+#define listIsEmpty LIST_NAME(LIST_PREFIX, listIsEmpty)
+#define listSize LIST_NAME(LIST_PREFIX, listSize)
+#define listAdd LIST_NAME(LIST_PREFIX, listAdd)
+#define listFromArray LIST_NAME(LIST_PREFIX, listFromArray)
+#define listAppendMany LIST_NAME(LIST_PREFIX, listAppendMany)
+#define listInsert LIST_NAME(LIST_PREFIX, listInsert)
+#define listToArray LIST_NAME(LIST_PREFIX, listToArray)
+#define listDisplay LIST_NAME(LIST_PREFIX, listDisplay)
+#define listBackendName LIST_NAME(LIST_PREFIX, listBackendName)
+#define listInsertSorted LIST_NAME(LIST_PREFIX, listInsertSorted)
+#define listInsertSortedMany LIST_NAME(LIST_PREFIX, listInsertSortedMany)
+#define listLowerBound LIST_NAME(LIST_PREFIX, listLowerBound)
+#define listFind LIST_NAME(LIST_PREFIX, listFind)
+#define sortQuick LIST_NAME(LIST_PREFIX, sortQuick)
+#define sortBubble LIST_NAME(LIST_PREFIX, sortBubble)
+#define sortInsertion LIST_NAME(LIST_PREFIX, sortInsertion)
+#define sortMerge LIST_NAME(LIST_PREFIX, sortMerge)
+#define sortAdaptive LIST_NAME(LIST_PREFIX, sortAdaptive)
+#define sortRadix LIST_NAME(LIST_PREFIX, sortRadix)
+#define sortSimd LIST_NAME(LIST_PREFIX, sortSimd)
+#define sortParallel LIST_NAME(LIST_PREFIX, sortParallel)
+#define sortParallelPool LIST_NAME(LIST_PREFIX, sortParallelPool)
+#define listOps LIST_NAME(LIST_PREFIX, listOps)
+
+#endif
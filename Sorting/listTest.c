@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "listOps.h"
+
+/* Checks of the list implementations that the benchmarks don't cover.
+ * Each sort is run on lists of several sizes, then more entities are added to the sorted list, which must still
+ * hold everything in the right place. Build it like ListBench, against one list implementation or all of them.
+ * Prints each failure and returns 1 if there were any.
+ *
+ * Usage: ListTest
+ */
+
+//struct def
+struct SortCase
+/* A sort to check, by name */
+{
+    const char* name;
+    void (*sort)(struct List* list);
+};
+//end struct def
+
+static const int sizes[] = {0, 1, 2, 100, 2000, 3000, 100000};
+
+static const struct ListOps* backends[] = LIST_BACKENDS;
+
+#define NUM_SIZES ((int)(sizeof(sizes) / sizeof(sizes[0])))
+#define NUM_BACKENDS ((int)(sizeof(backends) / sizeof(backends[0])))
+#define ADDS_AFTER_SORT 1000
+
+// Declare hidden functions
+int checkAddAfterSort(const struct ListOps* ops, struct SortCase sortCase, int size);
+int compareInts(const void* a, const void* b);
+
+int main(void)
+{
+    int failures = 0;
+
+    for (int backend = 0; backend < NUM_BACKENDS; backend++)
+    {
+        const struct ListOps* ops = backends[backend];
+        struct SortCase sortCases[] =
+        {
+            {"merge", ops->merge},
+            {"radix", ops->radix}
+        };
+
+        for (int c = 0; c < (int)(sizeof(sortCases) / sizeof(sortCases[0])); c++)
+        {
+            for (int s = 0; s < NUM_SIZES; s++)
+            {
+                failures += !checkAddAfterSort(ops, sortCases[c], sizes[s]);
+            }
+        }
+    }
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
+
+/** This function sorts a list of random entities, adds more to it and checks it holds them all in the right order.
+ * @param ops,      The list implementation.
+ * @param sortCase, The sort to run.
+ * @param size,     How many entities the list holds when it is sorted.
+ * @return,         1 if the list was right, 0 if not.
+ */
+int checkAddAfterSort(const struct ListOps* ops, struct SortCase sortCase, int size)
+{
+    int total = size + ADDS_AFTER_SORT;
+    int* expected = malloc(total * sizeof(int));
+    int* actual = malloc(total * sizeof(int));
+    struct List* list = ops->constructor();
+    int ok = (expected != NULL && actual != NULL && list != NULL);
+
+    srand(size + 1);
+    for (int i = 0; i < size && ok; i++)
+    {
+        expected[i] = rand() - RAND_MAX / 2;
+        ok = ops->add(list, expected[i]);
+    }
+    if (ok)
+    {
+        sortCase.sort(list);
+        qsort(expected, size, sizeof(int), compareInts);
+    }
+    for (int i = size; i < total && ok; i++)
+    {
+        expected[i] = rand() - RAND_MAX / 2;
+        ok = ops->add(list, expected[i]);
+    }
+    if (ok)
+    {
+        ok = (ops->size(list) == total);
+    }
+    if (ok)
+    {
+        ops->toArray(list, actual);
+        for (int i = 0; i < total && ok; i++)
+        {
+            ok = (actual[i] == expected[i]);
+        }
+    }
+    if (!ok)
+    {
+        printf("%s list, %s sort of %d entities then %d adds: wrong\n", ops->name, sortCase.name, size,
+               ADDS_AFTER_SORT);
+    }
+    if (list != NULL)
+    {
+        ops->destructor(list);
+    }
+    free(expected);
+    free(actual);
+    return ok;
+}
+
+int compareInts(const void* a, const void* b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
@@ -1,33 +1,513 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
 #include "list.h"
+#include "threadPool.h"
+#include "perfCounters.h"
 
-int main(){
+/* Benchmark harness for the list sorts.
+ * Sweeps list sizes by powers of ten and a set of input distributions, times every sort over a warm-up run
+ * and repeated trials, checks every result matches the C library's qsort entity for entity, and writes a CSV
+ * row for each combination. Builds against any of the list implementations.
+ * With -counters 1 the hardware counters (cycles, instructions, L1 data and last level cache misses, branch misses)
+ * and page faults are read around each sort on Linux and the medians added to the end of each row. The columns are
+ * always there, left empty where a counter isn't available. They are left empty for parallel rows too, the counters
+ * only follow the calling thread and the pool's threads do most of the work.
+ *
+ * Usage: Lists [-o results.csv] [-a quick,radix,bubble,insertion,merge,adaptive,simd,parallel] [-d random,sorted,...]
+ *              [-min n] [-max n] [-trials n] [-budget seconds] [-threads n] [-seed n] [-counters 0|1]
+ */
 
-    int numElements = 10;
-    struct List* mylist;
+// Define constants
+#define DEFAULT_MIN_SIZE 10
+#define DEFAULT_MAX_SIZE 100000000
+#define DEFAULT_TRIALS 5
+#define DEFAULT_BUDGET 10.0         // Seconds, a sort is not tried on a bigger list once it would take longer than this.
 
-    srand(clock());
+/** A sort being benchmarked, sorts that take a pool are run on pools of 1, 2, 4... threads up to the core count. */
+struct Algorithm
+{
+    const char* name;
+    void (*sort)(struct List* list);
+    void (*sortPool)(struct List* list, struct ThreadPool* pool);
+};
 
-    mylist = listConstructor();
+/** What the command line asked for. */
+struct Settings
+{
+    long long minSize;
+    long long maxSize;
+    int trials;
+    double budget;
+    struct PerfCounters* counters;      // NULL if the counters aren't being read.
+};
 
-    for (int i = 0; i < numElements; ++i)
+/** An input distribution. */
+struct Distribution
+{
+    const char* name;
+    void (*fill)(int* values, int size);
+};
+
+// Declare hidden functions
+double monotonicSeconds(void);
+uint64_t nextRandom(void);
+void fillRandom(int* values, int size);
+void fillSorted(int* values, int size);
+void fillReversed(int* values, int size);
+void fillNearlySorted(int* values, int size);
+void fillFewUnique(int* values, int size);
+void fillOrganPipe(int* values, int size);
+int benchmarkSizes(FILE* csv, const struct Settings* settings, const struct Algorithm* algorithm,
+                   const struct Distribution* distribution, int threads);
+struct List* buildList(int* values, int size);
+int verifyList(struct List* list, int* expected, int size, int* scratch);
+int compareDoubles(const void* a, const void* b);
+int compareLongLongs(const void* a, const void* b);
+int compareInts(const void* a, const void* b);
+int isSelected(const char* selection, const char* name);
+
+static uint64_t randomState = 88172645463325252ull;
+
+static const struct Algorithm algorithms[] =
+{
+    {"quick", sortQuick, NULL},
+    {"radix", sortRadix, NULL},
+    {"bubble", sortBubble, NULL},
+    {"insertion", sortInsertion, NULL},
+    {"merge", sortMerge, NULL},
+    {"adaptive", sortAdaptive, NULL},
+    {"simd", sortSimd, NULL},
+    {"parallel", NULL, sortParallelPool},
+};
+
+static const struct Distribution distributions[] =
+{
+    {"random", fillRandom},
+    {"sorted", fillSorted},
+    {"reversed", fillReversed},
+    {"nearly_sorted", fillNearlySorted},
+    {"few_unique", fillFewUnique},
+    {"organ_pipe", fillOrganPipe},
+};
+
+#define NUM_ALGORITHMS (int)(sizeof(algorithms) / sizeof(algorithms[0]))
+#define NUM_DISTRIBUTIONS (int)(sizeof(distributions) / sizeof(distributions[0]))
+
+int main(int argc, char* argv[])
+{
+    const char* csvName = "results.csv";
+    const char* algorithmSelection = NULL;
+    const char* distributionSelection = NULL;
+    struct Settings settings = {DEFAULT_MIN_SIZE, DEFAULT_MAX_SIZE, DEFAULT_TRIALS, DEFAULT_BUDGET, NULL};
+    int maxThreads = poolCoreCount();
+    int useCounters = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            printf("Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "-o") == 0) csvName = argv[++i];
+        else if (strcmp(argv[i], "-a") == 0) algorithmSelection = argv[++i];
+        else if (strcmp(argv[i], "-d") == 0) distributionSelection = argv[++i];
+        else if (strcmp(argv[i], "-min") == 0) settings.minSize = atoll(argv[++i]);
+        else if (strcmp(argv[i], "-max") == 0) settings.maxSize = atoll(argv[++i]);
+        else if (strcmp(argv[i], "-trials") == 0) settings.trials = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-budget") == 0) settings.budget = atof(argv[++i]);
+        else if (strcmp(argv[i], "-threads") == 0) maxThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-seed") == 0) randomState = strtoull(argv[++i], NULL, 10) * 2 + 1;
+        else if (strcmp(argv[i], "-counters") == 0) useCounters = atoi(argv[++i]);
+        else
+        {
+            printf("Usage: %s [-o results.csv] [-a quick,radix,bubble,insertion,merge,adaptive,simd,parallel] [-d random,sorted,reversed,"
+                   "nearly_sorted,few_unique,organ_pipe] [-min n] [-max n] [-trials n] [-budget seconds] [-threads n] "
+                   "[-seed n] [-counters 0|1]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (settings.trials < 1)
+    {
+        settings.trials = 1;
+    }
+    if (maxThreads < 1)
+    {
+        maxThreads = 1;
+    }
+    if (useCounters)
+    {
+        settings.counters = perfConstructor();
+        if (settings.counters == NULL)
+        {
+            printf("Performance counters aren't available (not Linux, or perf_event_paranoid is too high), "
+                   "carrying on without them\n");
+        }
+    }
+
+    FILE* csv = fopen(csvName, "w");
+    if (csv == NULL)
+    {
+        printf("Could not open %s\n", csvName);
+        return 1;
+    }
+    fprintf(csv, "backend,algorithm,threads,distribution,size,trials,min_s,median_s,mean_s,max_s,ns_per_element,"
+                 "verified");
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        fprintf(csv, ",%s", perfEventName(event));
+    }
+    fprintf(csv, "\n");
+
+    int failures = 0;
+    for (int d = 0; d < NUM_DISTRIBUTIONS; d++)
+    {
+        if (!isSelected(distributionSelection, distributions[d].name))
+        {
+            continue;
+        }
+        for (int a = 0; a < NUM_ALGORITHMS; a++)
+        {
+            if (!isSelected(algorithmSelection, algorithms[a].name))
+            {
+                continue;
+            }
+            if (algorithms[a].sortPool == NULL)
+            {
+                failures += benchmarkSizes(csv, &settings, &algorithms[a], &distributions[d], 1);
+                continue;
+            }
+            for (int threads = 1; ; threads *= 2)       // A scaling curve, 1, 2, 4... then the core count.
+            {
+                if (threads > maxThreads)
+                {
+                    threads = maxThreads;
+                }
+                failures += benchmarkSizes(csv, &settings, &algorithms[a], &distributions[d], threads);
+                if (threads == maxThreads)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    fclose(csv);
+    perfDestructor(settings.counters);
+    printf("Results written to %s\n", csvName);
+    return failures ? 1 : 0;
+}
+
+/** This function reads a clock that only ever goes forwards, in seconds.
+ */
+double monotonicSeconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double)count.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/** This function returns the next number from an xorshift64* generator, rand() only gives 15 bits on some compilers.
+ */
+uint64_t nextRandom(void)
+{
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 2685821657736338717ull;
+}
+
+// Input distributions
+
+void fillRandom(int* values, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        values[i] = (int)(nextRandom() >> 32);
+    }
+}
+
+void fillSorted(int* values, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        values[i] = i;
+    }
+}
+
+void fillReversed(int* values, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        values[i] = size - i;
+    }
+}
+
+/** Sorted, then 1% of the values swapped with a random other value. */
+void fillNearlySorted(int* values, int size)
+{
+    fillSorted(values, size);
+    for (int i = 0; i < size / 100 + 1; i++)
+    {
+        int a = (int)(nextRandom() % size);
+        int b = (int)(nextRandom() % size);
+        int temp = values[a];
+        values[a] = values[b];
+        values[b] = temp;
+    }
+}
+
+/** Random values from only 16 different ones. */
+void fillFewUnique(int* values, int size)
+{
+    for (int i = 0; i < size; i++)
     {
-        listAdd(mylist, rand()%100);
+        values[i] = (int)(nextRandom() % 16);
     }
-    //listDisplay(mylist);
-    printf("start");
-    double timestart = (double) clock();
-    sortQuick(mylist);
-    //sortBubble(mylist);
-    double timeend = (double) clock();
-    //listDisplay(mylist);
+}
+
+/** Rising to the middle then falling again. */
+void fillOrganPipe(int* values, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        values[i] = (i < size / 2) ? i : size - i;
+    }
+}
+
+// Periphery functions
 
-    double timetaken = (timeend - timestart) / CLOCKS_PER_SEC;
+/** This function times one sort on one input distribution for each list size, writing a CSV row per size.
+ * Sizes go up by ten until the sort would take longer than the budget.
+ * @param csv,          The results file.
+ * @param settings,     The sizes, trials and budget to use.
+ * @param algorithm,    The sort.
+ * @param distribution, The input distribution.
+ * @param threads,      The number of threads in the pool, for a sort that takes one.
+ * @return,             The number of sizes the sort got wrong.
+ */
+int benchmarkSizes(FILE* csv, const struct Settings* settings, const struct Algorithm* algorithm,
+                   const struct Distribution* distribution, int threads)
+{
+    double* times = malloc(settings->trials * sizeof(double));
+    long long* counts = malloc(settings->trials * PERF_EVENTS * sizeof(long long));    // counts[event * trials + trial]
+    double lastTime = 0;
+    double growth = 10;
+    int failures = 0;
+    struct PerfCounters* counters = (algorithm->sortPool == NULL) ? settings->counters : NULL;  // Calling thread only.
+    struct ThreadPool* pool = NULL;     // Kept for every size and trial, starting threads would be timed otherwise.
 
-    printf("Quick sort took %f seconds", timetaken);
-    listDestructor(mylist);
+    if (algorithm->sortPool != NULL)
+    {
+        pool = poolConstructor(threads);
+        if (pool == NULL || poolSize(pool) != threads)
+        {
+            printf("Could not start %d threads\n", threads);
+        }
+    }
+
+    for (long long size = settings->minSize; size <= settings->maxSize; size *= 10)
+    {
+        if (lastTime * growth > settings->budget)
+        {
+            printf("%s %s: stopping before %lld, would take about %.0f s\n",
+                   algorithm->name, distribution->name, size, lastTime * growth);
+            break;
+        }
+        int n = (int)size;
+        int* values = malloc(n * sizeof(int));
+        int* expected = malloc(n * sizeof(int));
+        int* scratch = malloc(n * sizeof(int));
+        if (values == NULL || expected == NULL || scratch == NULL)
+        {
+            printf("Out of memory at %d elements\n", n);
+            free(values);
+            free(expected);
+            free(scratch);
+            break;
+        }
+        distribution->fill(values, n);
+        memcpy(expected, values, n * sizeof(int));
+        qsort(expected, n, sizeof(int), compareInts);      // The C library's sort is the reference.
+
+        int verified = 1;
+        int kept = 0;
+        for (int trial = -1; trial < settings->trials; trial++)     // Trial -1 is the warm-up, it isn't kept.
+        {
+            struct List* list = buildList(values, n);
+            long long trialCounts[PERF_EVENTS];
+            if (counters != NULL)
+            {
+                perfStart(counters);
+            }
+            double start = monotonicSeconds();
+            if (algorithm->sortPool != NULL)
+            {
+                algorithm->sortPool(list, pool);
+            }
+            else
+            {
+                algorithm->sort(list);
+            }
+            double taken = monotonicSeconds() - start;
+            if (counters != NULL)
+            {
+                perfStop(counters, trialCounts);
+            }
+            if (!verifyList(list, expected, n, scratch))
+            {
+                verified = 0;
+            }
+            listDestructor(list);
+            if (trial >= 0 || taken > settings->budget)
+            {
+                for (int event = 0; event < PERF_EVENTS && counters != NULL; event++)
+                {
+                    counts[event * settings->trials + kept] = trialCounts[event];
+                }
+                times[kept++] = taken;
+            }
+            if (taken > settings->budget)
+            {
+                break;      // One slow run is enough to know.
+            }
+        }
+
+        double mean = 0;
+        qsort(times, kept, sizeof(double), compareDoubles);
+        for (int i = 0; i < kept; i++)
+        {
+            mean += times[i];
+        }
+        mean /= kept;
+        double median = times[kept / 2];
+        fprintf(csv, "%s,%s,%d,%s,%d,%d,%.9f,%.9f,%.9f,%.9f,%.3f,%d", listBackendName(), algorithm->name, threads,
+                distribution->name, n, kept, times[0], median, mean, times[kept - 1], median * 1e9 / n, verified);
+        for (int event = 0; event < PERF_EVENTS; event++)
+        {
+            long long* eventCounts = &counts[event * settings->trials];
+            if (counters != NULL)
+            {
+                qsort(eventCounts, kept, sizeof(long long), compareLongLongs);
+            }
+            if (counters != NULL && eventCounts[kept / 2] >= 0)
+            {
+                fprintf(csv, ",%lld", eventCounts[kept / 2]);
+            }
+            else
+            {
+                fprintf(csv, ",");
+            }
+        }
+        fprintf(csv, "\n");
+        fflush(csv);
+        printf("%-8s %-10s %3d %-14s %10d  median %.6f s  %s\n", listBackendName(), algorithm->name, threads,
+               distribution->name, n, median, verified ? "ok" : "NOT SORTED");
+        failures += !verified;
+
+        if (lastTime > 0 && median > lastTime * 10)
+        {
+            growth = median / lastTime;     // Worse than linear, expect the same again next time.
+        }
+        lastTime = median;
+        free(values);
+        free(expected);
+        free(scratch);
+    }
+    if (pool != NULL)
+    {
+        poolDestructor(pool);
+    }
+    free(times);
+    free(counts);
+    return failures;
+}
+
+/** This function makes a new list holding the values in order.
+ * @param values,   The values to go in the list.
+ * @param size,     How many values there are.
+ */
+struct List* buildList(int* values, int size)
+{
+    struct List* list = listFromArray(values, size);
+    if (list == NULL)
+    {
+        printf("Out of memory building a list of %d\n", size);
+        exit(1);
+    }
+    return list;
+}
+
+/** This function checks a sorted list matches the reference sort entity for entity.
+ * There is only one sorted order of a set of ints, so every sort has to give exactly this.
+ * @param list,     The sorted list.
+ * @param expected, The values it was built from, sorted by qsort.
+ * @param size,     How many values there are.
+ * @param scratch,  Space for size ints.
+ * @return,         1 if it is correct.
+ */
+int verifyList(struct List* list, int* expected, int size, int* scratch)
+{
+    if (listSize(list) != size)
+    {
+        return 0;
+    }
+    memset(scratch, 0, size * sizeof(int));
+    listToArray(list, scratch);
+    return memcmp(scratch, expected, size * sizeof(int)) == 0;
+}
+
+int compareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int compareLongLongs(const void* a, const void* b)
+{
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+int compareInts(const void* a, const void* b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/** This function checks whether a name is in a comma separated selection, everything is selected if there isn't one.
+ */
+int isSelected(const char* selection, const char* name)
+{
+    if (selection == NULL)
+    {
+        return 1;
+    }
+    size_t length = strlen(name);
+    const char* place = selection;
+    while ((place = strstr(place, name)) != NULL)
+    {
+        if ((place == selection || place[-1] == ',') && (place[length] == ',' || place[length] == '\0'))
+        {
+            return 1;
+        }
+        place += length;
+    }
     return 0;
 }
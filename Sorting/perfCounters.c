@@ -0,0 +1,173 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "perfCounters.h"
+
+// Declare hidden functions
+int perfOpen(unsigned int type, unsigned long long config);
+
+//struct def
+struct PerfCounters
+/* One file descriptor per event, -1 for events that couldn't be opened */
+{
+    int files[PERF_EVENTS];
+};
+//end struct def
+
+static const char* eventNames[PERF_EVENTS] =
+{
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "page_faults"
+};
+
+struct PerfCounters* perfConstructor(void)
+/* Opens the counters */
+{
+#ifdef __linux__
+    struct PerfCounters* counters = malloc(sizeof(struct PerfCounters));
+    int opened = 0;
+
+    if (counters == NULL)
+    {
+        return NULL;
+    }
+    counters->files[PERF_CYCLES] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    counters->files[PERF_INSTRUCTIONS] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    counters->files[PERF_L1D_MISSES] = perfOpen(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    counters->files[PERF_LLC_MISSES] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    counters->files[PERF_BRANCH_MISSES] = perfOpen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    counters->files[PERF_PAGE_FAULTS] = perfOpen(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        opened += (counters->files[event] >= 0);
+    }
+    if (opened == 0)
+    {
+        free(counters);
+        return NULL;
+    }
+    return counters;
+#else
+    return NULL;
+#endif
+}
+
+void perfDestructor(struct PerfCounters* counters)
+/* Closes the counters */
+{
+    if (counters == NULL)
+    {
+        return;
+    }
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        if (counters->files[event] >= 0)
+        {
+            close(counters->files[event]);
+        }
+    }
+#endif
+    free(counters);
+}
+
+void perfStart(struct PerfCounters* counters)
+/* Zeroes and starts the counters */
+{
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        if (counters->files[event] >= 0)
+        {
+            ioctl(counters->files[event], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->files[event], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+void perfStop(struct PerfCounters* counters, long long values[PERF_EVENTS])
+/* Stops and reads the counters */
+{
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        values[event] = -1;
+    }
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        if (counters->files[event] >= 0)
+        {
+            ioctl(counters->files[event], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int event = 0; event < PERF_EVENTS; event++)
+    {
+        unsigned long long reading[3];      // Value, time enabled, time running.
+        if (counters->files[event] < 0 ||
+            read(counters->files[event], reading, sizeof(reading)) != (ssize_t)sizeof(reading))
+        {
+            continue;
+        }
+        if (reading[2] == 0)
+        {
+            values[event] = (reading[1] == 0) ? 0 : -1;     // Never got a turn on the hardware.
+        }
+        else if (reading[2] < reading[1])
+        {
+            values[event] = (long long)((double)reading[0] * reading[1] / reading[2]);
+        }
+        else
+        {
+            values[event] = (long long)reading[0];
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+const char* perfEventName(int event)
+/* Name of an event */
+{
+    return eventNames[event];
+}
+
+
+// Hidden functions
+
+/** This function opens one counter for the calling thread, stopped, counting user space only.
+ * @param type,     The perf event type.
+ * @param config,   The event within that type.
+ * @return,         The counter's file descriptor, or -1 if it can't be opened.
+ */
+int perfOpen(unsigned int type, unsigned long long config)
+{
+#ifdef __linux__
+    struct perf_event_attr attributes;
+
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.inherit = 0;             // A pool's threads outlive the sort, their counts would land when they exit.
+    attributes.exclude_kernel = 1;      // Allowed at the default perf_event_paranoid level.
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#else
+    (void)type;
+    (void)config;
+    return -1;
+#endif
+}
@@ -0,0 +1,33 @@
+/* Hardware and software performance counters for the sort benchmarks, through Linux's perf_event_open.
+ * Each counter is opened on its own, so one the CPU or kernel won't give doesn't stop the others. Only the user
+ * space side of the calling thread is counted, not threads it starts. On other systems, or where perf events
+ * aren't allowed, perfConstructor returns NULL and nothing is counted.
+ */
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+enum PerfEvent
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_EVENTS
+};
+
+struct PerfCounters;
+
+struct PerfCounters* perfConstructor(void);
+/* opens every counter it can, returns NULL if it couldn't open any */
+void perfDestructor(struct PerfCounters* counters);
+/* closes the counters */
+void perfStart(struct PerfCounters* counters);
+/* zeroes the counters and starts them counting */
+void perfStop(struct PerfCounters* counters, long long values[PERF_EVENTS]);
+/* stops the counters and reads them, scaled up if the kernel had to share them out, -1 for any that aren't open */
+const char* perfEventName(int event);
+/* name of an event, as used for its CSV column */
+
+#endif
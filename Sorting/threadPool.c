@@ -0,0 +1,314 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "threadPool.h"
+
+// Define constants
+#define QUEUE_FIRST_CAPACITY 64
+
+// Declare hidden functions
+void* poolLoop(void* argument);
+void poolWork(struct ThreadPool* pool, int worker);
+int poolTake(struct ThreadPool* pool, int worker, struct PoolTask* task);
+
+//struct def
+struct TaskQueue
+/* One worker's tasks, tasks[start..end-1] are waiting */
+{
+    pthread_mutex_t lock;
+    struct PoolTask* tasks;
+    int start;
+    int end;
+    int capacity;
+};
+
+struct ThreadPool
+{
+    int size;
+    struct TaskQueue* queues;       // One per worker, the thread calling poolRun is worker 0.
+    pthread_t* threads;             // Workers 1 and up.
+
+    atomic_int remaining;           // Tasks queued or running in this run.
+    pthread_mutex_t lock;           // Guards batch and stopping.
+    pthread_cond_t wake;            // Workers wait on this for the next run.
+    int batch;                      // Counts runs so the workers can tell a new one.
+    int stopping;                   // Set by poolDestructor.
+};
+
+struct WorkerStart
+/* What a worker thread is given when it starts */
+{
+    struct ThreadPool* pool;
+    int worker;
+};
+//end struct def
+
+struct ThreadPool* poolConstructor(int threads)
+/* Starts a pool of threads */
+{
+    struct ThreadPool* pool = malloc(sizeof(struct ThreadPool));
+
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    if (threads <= 0)
+    {
+        threads = poolCoreCount();
+    }
+    pool->queues = malloc(threads * sizeof(struct TaskQueue));
+    pool->threads = malloc(threads * sizeof(pthread_t));
+    if (pool->queues == NULL || pool->threads == NULL)
+    {
+        free(pool->queues);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->remaining, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pool->batch = 0;
+    pool->stopping = 0;
+
+    for (int i = 0; i < threads; i++)
+    {
+        pool->queues[i].tasks = malloc(QUEUE_FIRST_CAPACITY * sizeof(struct PoolTask));
+        if (pool->queues[i].tasks == NULL)
+        {
+            threads = i;        // Make do with the workers there is memory for.
+            break;
+        }
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].start = 0;
+        pool->queues[i].end = 0;
+        pool->queues[i].capacity = QUEUE_FIRST_CAPACITY;
+    }
+    pool->size = threads;
+    if (threads == 0)
+    {
+        poolDestructor(pool);
+        return NULL;
+    }
+    for (int i = 1; i < threads; i++)
+    {
+        struct WorkerStart* start = malloc(sizeof(struct WorkerStart));
+        if (start != NULL)
+        {
+            start->pool = pool;
+            start->worker = i;
+        }
+        if (start == NULL || pthread_create(&pool->threads[i], NULL, poolLoop, start) != 0)
+        {
+            free(start);
+            pool->size = i;         // Only workers below i were started, so only they are joined.
+            break;
+        }
+    }
+    for (int i = pool->size; i < threads; i++)     // Queues of workers that couldn't be started.
+    {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    return pool;
+}
+
+void poolDestructor(struct ThreadPool* pool)
+/* Stops and joins the threads */
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->size; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->size; i++)
+    {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    free(pool->queues);
+    free(pool->threads);
+    free(pool);
+}
+
+int poolSize(struct ThreadPool* pool)
+/* Number of threads, counting the caller */
+{
+    return pool->size;
+}
+
+void poolRun(struct ThreadPool* pool, struct PoolTask task)
+/* Runs a task and everything it queues */
+{
+    if (!poolSubmit(pool, 0, task))
+    {
+        task.run(pool, 0, task);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->batch ++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    poolWork(pool, 0);
+}
+
+int poolSubmit(struct ThreadPool* pool, int worker, struct PoolTask task)
+/* Queues a task on a worker's queue */
+{
+    struct TaskQueue* queue = &pool->queues[worker];
+    struct PoolTask* tasks;
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->end == queue->capacity)
+    {
+        if (queue->start > 0)       // Stolen from the front, slide what's left down.
+        {
+            memmove(queue->tasks, &queue->tasks[queue->start], (queue->end - queue->start) * sizeof(struct PoolTask));
+            queue->end -= queue->start;
+            queue->start = 0;
+        }
+        else
+        {
+            tasks = realloc(queue->tasks, 2 * queue->capacity * sizeof(struct PoolTask));
+            if (tasks == NULL)
+            {
+                pthread_mutex_unlock(&queue->lock);
+                return 0;
+            }
+            queue->tasks = tasks;
+            queue->capacity *= 2;
+        }
+    }
+    atomic_fetch_add(&pool->remaining, 1);      // Before it can be taken, so the run can't look finished.
+    queue->tasks[queue->end] = task;
+    queue->end ++;
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+int poolCoreCount(void)
+/* Number of cores online */
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cores > 0) ? (int)cores : 1;
+#endif
+}
+
+
+// Hidden functions
+
+/** This function is a worker thread, it waits for each run and works on it.
+ * @param argument, The WorkerStart for this thread, freed here.
+ */
+void* poolLoop(void* argument)
+{
+    struct WorkerStart* start = argument;
+    struct ThreadPool* pool = start->pool;
+    int worker = start->worker;
+    int seen = 0;
+
+    free(start);
+    while (1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stopping && pool->batch == seen)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        poolWork(pool, worker);
+    }
+}
+
+/** This function runs tasks until every task in the run has finished.
+ * A worker with nothing to take yields rather than sleeps, as a running task may be about to queue more.
+ * @param pool,     The pool.
+ * @param worker,   The worker's number.
+ */
+void poolWork(struct ThreadPool* pool, int worker)
+{
+    struct PoolTask task;
+
+    while (atomic_load(&pool->remaining) > 0)
+    {
+        if (poolTake(pool, worker, &task))
+        {
+            task.run(pool, worker, task);
+            atomic_fetch_sub(&pool->remaining, 1);
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+}
+
+/** This function takes a task, from the back of the worker's own queue or failing that the front of another's.
+ * @param pool,     The pool.
+ * @param worker,   The worker's number.
+ * @param task,     Set to the task taken.
+ * @return,         1 if a task was taken.
+ */
+int poolTake(struct ThreadPool* pool, int worker, struct PoolTask* task)
+{
+    for (int i = 0; i < pool->size; i++)
+    {
+        struct TaskQueue* queue = &pool->queues[(worker + i) % pool->size];
+        int taken = 0;
+
+        pthread_mutex_lock(&queue->lock);
+        if (queue->start < queue->end)
+        {
+            if (i == 0)
+            {
+                queue->end --;
+                *task = queue->tasks[queue->end];
+            }
+            else
+            {
+                *task = queue->tasks[queue->start];     // Steal from the other end to the owner, the bigger tasks.
+                queue->start ++;
+            }
+            if (queue->start == queue->end)
+            {
+                queue->start = 0;
+                queue->end = 0;
+            }
+            taken = 1;
+        }
+        pthread_mutex_unlock(&queue->lock);
+        if (taken)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/* Work stealing thread pool for the list sorts.
+ * Each worker has its own queue of tasks and takes from the back of it, a worker that runs out takes from the
+ * front of someone else's. Tasks can queue more tasks, so a sort can split its work as it goes.
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+struct ThreadPool;
+
+struct PoolTask
+/* A piece of work, the function to run and the section of data it covers */
+{
+    void (*run)(struct ThreadPool* pool, int worker, struct PoolTask task);
+    void* context;
+    int low;
+    int high;
+    int depth;
+};
+
+struct ThreadPool* poolConstructor(int threads);
+/* starts a pool of threads, counting the thread that calls poolRun, 0 or less for one per core. Fewer if not all of
+   them can be started, NULL if there is no memory for the pool */
+void poolDestructor(struct ThreadPool* pool);
+/* stops and joins the threads */
+int poolSize(struct ThreadPool* pool);
+/* number of threads, counting the caller */
+void poolRun(struct ThreadPool* pool, struct PoolTask task);
+/* runs a task and every task it queues, on the pool and the calling thread, and returns when they are all done */
+int poolSubmit(struct ThreadPool* pool, int worker, struct PoolTask task);
+/* queues another task from inside a running task, worker is the number the running task was given.
+   Returns 0 if there was no memory to queue it, the caller has to run it itself */
+int poolCoreCount(void);
+/* number of cores the machine has online */
+
+#endif
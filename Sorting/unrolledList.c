@@ -0,0 +1,1113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef LIST_ALL_BACKENDS
+#define LIST_PREFIX unrolled
+#endif
+#include "list.h"
+#include "listOps.h"
+
+/* An unrolled linked list: each node is one cache line, holding as many entities as fit beside its count and
+ * pointers instead of just one, so walking the list reads mostly ints rather than pointers, and inserting in the
+ * middle only moves entities within one node.
+ */
+
+// Define constants
+#define CACHE_LINE 64
+#define BLOCK_ENTITIES ((int)((CACHE_LINE - sizeof(int) - 2 * sizeof(void*)) / sizeof(int)))   // 10 on 64 bit.
+#define QUICK_SORT_CUTOFF 16        // Ranges this size or smaller are finished off with insertion sort.
+#define RADIX_BITS 8                // Bits per radix sort digit, 4 passes cover 32 bit ints.
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+// Declare hidden functions
+struct BlockCursor;
+struct ListNode* blockConstructor(void);
+void blockDestructor(struct ListNode* block);
+struct ListNode* insertInBlock(struct List* list, struct ListNode* block, int place, int entity);
+int* gatherEntities(struct List* list);
+void scatterEntities(struct List* list, int* array);
+void insertionSortArray(int* array, int size);
+void mergeArrayRanges(int* from, int* to, int low, int middle, int high);
+void quickSortArray(int* array, int low, int high, int depthLimit);
+void swapEntities(int* a, int* b);
+void heapSortArray(int* array, int size);
+void siftDownArray(int* array, int root, int size);
+void reverseDescendingRuns(int* array, int size);
+int runEnd(int* array, int low, int size);
+void cursorNext(struct BlockCursor* cursor);
+void cursorPrev(struct BlockCursor* cursor);
+void combSortBlocks(struct List* list);
+
+// struct def
+struct ListNode
+/* A block of entities, only the first count are in use */
+{
+    int entities[BLOCK_ENTITIES];
+    int count;
+
+    struct ListNode* next;
+    struct ListNode* prev;
+};
+_Static_assert(sizeof(struct ListNode) == CACHE_LINE, "a block should fill one cache line");
+
+struct List
+{
+    int size;
+    int isSorted;
+
+    struct ListNode* head;
+    struct ListNode* tail;
+};
+
+struct BlockCursor
+/* An entity's place in the list, the block holding it and its index in the block */
+{
+    struct ListNode* block;
+    int place;
+};
+//end struct def
+
+struct List* listConstructor()
+/* Dynamically creates a list*/
+{
+    struct List* unrolledList;
+
+    unrolledList = malloc(sizeof(struct List));
+    if (unrolledList == NULL)
+    {
+        return NULL;
+    }
+
+    unrolledList->size = 0;
+    unrolledList->isSorted = 1;
+    unrolledList->head = NULL;
+    unrolledList->tail = NULL;
+
+    return unrolledList;
+}
+
+void listDestructor(struct List* list)
+/* Destroys a list */
+{
+    struct ListNode* block = list->head;
+    struct ListNode* nextBlock;
+
+    while (block != NULL)
+    {
+        nextBlock = block->next;
+        blockDestructor(block);
+        block = nextBlock;
+    }
+    free(list);
+}
+
+int listSize(struct List* list)
+/* Checks size of list */
+{
+    return list->size;
+}
+
+int listIsEmpty(struct List* list)
+/* Checks if a list is empty */
+{
+    return list->size == 0;
+}
+
+int listAdd(struct List* list, int entity)
+/* Add an entity to a list */
+{
+    struct ListNode* block = list->tail;
+
+    if (block == NULL || block->count == BLOCK_ENTITIES)
+    {
+        block = blockConstructor();
+        if (block == NULL)
+        {
+            return 0;
+        }
+        block->prev = list->tail;
+        if (list->tail)
+        {
+            list->tail->next = block;
+        }
+        else
+        {
+            list->head = block;
+        }
+        list->tail = block;
+    }
+    if (list->size > 0 && list->isSorted)
+    {
+        struct ListNode* last = (block->count > 0) ? block : block->prev;
+        list->isSorted = (last->entities[last->count - 1] <= entity);
+    }
+    block->entities[block->count] = entity;
+    block->count ++;
+    list->size ++;
+    return 1;
+}
+
+struct List* listFromArray(const int* array, size_t count)
+/* Makes a list from an array */
+{
+    struct List* list = listConstructor();
+
+    if (list == NULL)
+    {
+        return NULL;
+    }
+    if (!listAppendMany(list, array, count))
+    {
+        listDestructor(list);
+        return NULL;
+    }
+    return list;
+}
+
+int listAppendMany(struct List* list, const int* array, size_t count)
+/* Adds an array of entities to the end of a list */
+{
+    size_t place = 0;
+
+    while (place < count)
+    {
+        if (!listAdd(list, array[place]))       // Opens a new block when the last one is full...
+        {
+            return 0;
+        }
+        place ++;
+
+        struct ListNode* block = list->tail;    // ...then the rest of the block is filled in one copy.
+        size_t room = BLOCK_ENTITIES - block->count;
+        size_t take = (count - place < room) ? count - place : room;
+        memcpy(&block->entities[block->count], &array[place], take * sizeof(int));
+        block->count += (int)take;
+        list->size += (int)take;
+        for (size_t i = place; i < place + take && list->isSorted; i++)
+        {
+            list->isSorted = (array[i - 1] <= array[i]);
+        }
+        place += take;
+    }
+    return 1;
+}
+
+int listInsert(struct List* list, int index, int entity)
+/* Inserts an entity before the one at index */
+{
+    struct ListNode* block = list->head;
+
+    if (index < 0 || index > list->size)
+    {
+        return 0;
+    }
+    if (index == list->size)
+    {
+        return listAdd(list, entity);
+    }
+    while (index >= block->count)       // Whole blocks are skipped by their count.
+    {
+        index -= block->count;
+        block = block->next;
+    }
+    if (list->isSorted)     // Still sorted if it goes between the entities either side.
+    {
+        if (index > 0)
+        {
+            list->isSorted = (block->entities[index - 1] <= entity);
+        }
+        else if (block->prev != NULL)
+        {
+            list->isSorted = (block->prev->entities[block->prev->count - 1] <= entity);
+        }
+        list->isSorted = list->isSorted && (entity <= block->entities[index]);
+    }
+    if (insertInBlock(list, block, index, entity) == NULL)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+int listInsertSorted(struct List* list, int entity)
+/* Inserts an entity into a sorted list, after any equal entities */
+{
+    struct ListNode* block = list->head;
+    int place;
+
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+        block = list->head;
+    }
+    while (block != NULL && block->entities[block->count - 1] <= entity)     // Only the last entity of a block is read.
+    {
+        block = block->next;
+    }
+    if (block == NULL)
+    {
+        return listAdd(list, entity);
+    }
+    place = 0;
+    while (block->entities[place] <= entity)
+    {
+        place ++;
+    }
+    return insertInBlock(list, block, place, entity) != NULL;
+}
+
+int listInsertSortedMany(struct List* list, const int* array, size_t count)
+/* Sorts an array of entities and merges them into a sorted list */
+{
+    struct List* batch;
+    int* from;
+    int* to;
+    int n = list->size;
+
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+    }
+    if (count == 0)
+    {
+        return 1;
+    }
+    batch = listFromArray(array, count);
+    if (batch == NULL)
+    {
+        return 0;
+    }
+    sortAdaptive(batch);
+    from = malloc((n + count) * sizeof(int));
+    to = malloc((n + count) * sizeof(int));
+    if (from == NULL || to == NULL)
+    {
+        free(from);
+        free(to);
+        listDestructor(batch);
+        return 0;
+    }
+    listToArray(list, from);
+    listToArray(batch, &from[n]);
+    mergeArrayRanges(from, to, 0, n, n + (int)count);
+
+    scatterEntities(list, to);              // The list's blocks take the first n, the batch's blocks the rest,
+    scatterEntities(batch, &to[n]);         // so nothing is allocated once the list starts changing.
+    if (batch->head != NULL)
+    {
+        batch->head->prev = list->tail;
+        if (list->tail)
+        {
+            list->tail->next = batch->head;
+        }
+        else
+        {
+            list->head = batch->head;
+        }
+        list->tail = batch->tail;
+        list->size += batch->size;
+        batch->head = NULL;
+        batch->tail = NULL;
+    }
+    listDestructor(batch);
+    free(from);
+    free(to);
+    return 1;
+}
+
+int listLowerBound(struct List* list, int entity)
+/* Finds the index of the first entity not lower than entity in a sorted list */
+{
+    struct ListNode* block;
+    int index = 0;
+    int low = 0;
+    int high;
+
+    if (!list->isSorted)
+    {
+        sortAdaptive(list);
+    }
+    block = list->head;
+    while (block != NULL && block->entities[block->count - 1] < entity)     // Whole blocks are skipped by their last entity.
+    {
+        index += block->count;
+        block = block->next;
+    }
+    if (block == NULL)
+    {
+        return index;
+    }
+    high = block->count;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (block->entities[middle] < entity)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return index + low;
+}
+
+int listFind(struct List* list, int entity)
+/* Finds the index of an entity in a sorted list, or -1 if it isn't there */
+{
+    int index = listLowerBound(list, entity);
+    struct ListNode* block = list->head;
+    int place = index;
+
+    while (block != NULL && place >= block->count)
+    {
+        place -= block->count;
+        block = block->next;
+    }
+    if (block != NULL && block->entities[place] == entity)
+    {
+        return index;
+    }
+    return -1;
+}
+
+void listToArray(struct List* list, int* array)
+/* Copies a list into an array */
+{
+    struct ListNode* block = list->head;
+
+    while (block != NULL)
+    {
+        memcpy(array, block->entities, block->count * sizeof(int));
+        array += block->count;
+        block = block->next;
+    }
+}
+
+const char* listBackendName(void)
+/* Name of this list implementation */
+{
+    return "unrolled";
+}
+
+const struct ListOps listOps =
+/* This list implementation's functions, for programs that compare it with the others */
+{
+    "unrolled", listConstructor, listDestructor, listIsEmpty, listSize, listAdd, listFromArray, listAppendMany,
+    listInsert, listToArray, listInsertSorted, listInsertSortedMany, listLowerBound, listFind, sortQuick, sortBubble,
+    sortInsertion, sortMerge, sortAdaptive, sortRadix, sortSimd, sortParallel, sortParallelPool
+};
+
+void listDisplay (struct List* list)
+/* Displays a list*/
+{
+    struct ListNode* block = list->head;
+    int place = 1;
+
+    while (block != NULL)
+    {
+        for (int i = 0; i < block->count; i++)
+        {
+            printf((place == list->size) ? "%d.\n" : "%d, ", block->entities[i]);
+            place ++;
+        }
+        block = block->next;
+    }
+}
+
+
+// Sorting algorithms
+// Insertion and bubble sort work on the blocks in place. The others copy the entities out into one array, sort them
+// there and copy them back, so every block keeps its count. If there is no memory for the copy they comb sort the
+// blocks in place instead, rather than leave the list unsorted.
+
+/** This function will sort a list using insertion sort.
+ * Works on the blocks in place, each entity is walked back through the blocks until it finds its place.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortInsertion(struct List* list)
+{
+    struct BlockCursor next = {list->head, 0};
+    struct BlockCursor hole;
+    struct BlockCursor before;
+    int temp;
+
+    for (int i = 1; i < list->size; i++)
+    {
+        cursorNext(&next);
+        temp = next.block->entities[next.place];
+        hole = next;
+        before = next;
+        cursorPrev(&before);
+        for (int j = i; j > 0 && before.block->entities[before.place] > temp; j--)
+        {
+            hole.block->entities[hole.place] = before.block->entities[before.place];
+            hole = before;
+            if (j > 1)
+            {
+                cursorPrev(&before);
+            }
+        }
+        hole.block->entities[hole.place] = temp;
+    }
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using bubble sort.
+ * Works on the blocks in place, each pass stops where the previous one last swapped.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortBubble(struct List* list)
+{
+    struct BlockCursor left;
+    struct BlockCursor right;
+    int end = list->size;
+    int lastSwap;
+    int temp;
+
+    while (end > 1)
+    {
+        lastSwap = 0;
+        left.block = list->head;
+        left.place = 0;
+        right = left;
+        cursorNext(&right);
+        for (int i = 1; i < end; i++)
+        {
+            if (left.block->entities[left.place] > right.block->entities[right.place])
+            {
+                temp = left.block->entities[left.place];
+                left.block->entities[left.place] = right.block->entities[right.place];
+                right.block->entities[right.place] = temp;
+                lastSwap = i;
+            }
+            left = right;
+            cursorNext(&right);
+        }
+        end = lastSwap;
+    }
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using quick sort.
+ * Introsort on the copied out entities: Hoare partitions around a median of three, insertion sort for small
+ * ranges and heap sort for any range that recurses too deep.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortQuick(struct List* list)
+{
+    int n = list->size;
+    int* array;
+    int depthLimit = 0;
+
+    if (n < 2)
+    {
+        list->isSorted = 1;
+        return;
+    }
+    array = gatherEntities(list);
+    if (array == NULL)
+    {
+        combSortBlocks(list);
+        return;
+    }
+    for (int size = n; size > 1; size >>= 1)
+    {
+        depthLimit += 2;
+    }
+    quickSortArray(array, 0, n - 1, depthLimit);
+    scatterEntities(list, array);
+    free(array);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using a bottom up merge sort.
+ * Each block's worth of entities is insertion sorted, then the runs are merged back and forth between two arrays.
+ * Stable, unless there is no memory and it falls back to the comb sort.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortMerge(struct List* list)
+{
+    int n = list->size;
+    int* from;
+    int* to;
+    int* temp;
+
+    if (n < 2)
+    {
+        list->isSorted = 1;
+        return;
+    }
+    from = gatherEntities(list);
+    to = malloc(n * sizeof(int));
+    if (from == NULL || to == NULL)
+    {
+        free(from);
+        free(to);
+        combSortBlocks(list);
+        return;
+    }
+    for (int low = 0; low < n; low += BLOCK_ENTITIES)
+    {
+        insertionSortArray(&from[low], (n - low < BLOCK_ENTITIES) ? n - low : BLOCK_ENTITIES);
+    }
+    for (int width = BLOCK_ENTITIES; width < n; width *= 2)
+    {
+        for (int low = 0; low < n; low += 2 * width)
+        {
+            int middle = (low + width < n) ? low + width : n;
+            int high = (low + 2 * width < n) ? low + 2 * width : n;
+            mergeArrayRanges(from, to, low, middle, high);
+        }
+        temp = from;
+        from = to;
+        to = temp;
+    }
+    scatterEntities(list, from);
+    free(from);
+    free(to);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list by merging the runs already in it, and does nothing if the list is already sorted.
+ * Strictly descending runs are turned around first, then neighbouring runs are merged in passes until one is left.
+ * O(n) on sorted or reversed lists. Stable, unless there is no memory and it falls back to the comb sort.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortAdaptive(struct List* list)
+{
+    int n = list->size;
+    int* from;
+    int* to;
+    int* temp;
+    int runs;
+
+    if (list->isSorted)
+    {
+        return;
+    }
+    from = gatherEntities(list);
+    to = malloc(n * sizeof(int));
+    if (from == NULL || to == NULL)
+    {
+        free(from);
+        free(to);
+        combSortBlocks(list);
+        return;
+    }
+    reverseDescendingRuns(from, n);
+    do
+    {
+        runs = 0;
+        for (int low = 0; low < n; runs++)
+        {
+            int middle = runEnd(from, low, n);
+            int high = (middle < n) ? runEnd(from, middle, n) : n;
+            mergeArrayRanges(from, to, low, middle, high);
+            low = high;
+        }
+        temp = from;
+        from = to;
+        to = temp;
+    } while (runs > 1);
+    scatterEntities(list, from);
+    free(from);
+    free(to);
+    list->isSorted = 1;
+}
+
+/** This function will sort a list using a least significant digit radix sort.
+ * The copied out entities are counted into RADIX_BUCKETS buckets a digit at a time, between two arrays. The sign bit
+ * is flipped on the top digit so negative numbers come first. Stable.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortRadix(struct List* list)
+{
+    int n = list->size;
+    unsigned int* from;
+    unsigned int* to;
+    unsigned int* temp;
+    int counts[RADIX_BUCKETS];
+    int total;
+    int count;
+
+    if (n < 2)
+    {
+        list->isSorted = 1;
+        return;
+    }
+    from = (unsigned int*)gatherEntities(list);
+    to = malloc(n * sizeof(int));
+    if (from == NULL || to == NULL)
+    {
+        free(from);
+        free(to);
+        combSortBlocks(list);
+        return;
+    }
+    for (int shift = 0; shift < 32; shift += RADIX_BITS)
+    {
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < n; i++)
+        {
+            counts[((from[i] ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++;
+        }
+        total = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++)     // Counts become where each bucket starts.
+        {
+            count = counts[bucket];
+            counts[bucket] = total;
+            total += count;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            to[counts[((from[i] ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+        }
+        temp = from;
+        from = to;
+        to = temp;
+    }
+    scatterEntities(list, (int*)from);
+    free(from);
+    free(to);
+    list->isSorted = 1;
+}
+
+/** This function sorts a list for callers that want the vectorised sort.
+ * The unrolled list is sorted with the quick sort, only the array list has a vectorised sort.
+ * @param list, The unrolled list to be sorted.
+ */
+void sortSimd(struct List* list)
+{
+    sortQuick(list);
+}
+
+/** This function sorts a list for callers that want a parallel sort.
+ * The unrolled list is sorted with the quick sort on the calling thread, only the array list splits sorts
+ * across threads.
+ * @param list,     The unrolled list to be sorted.
+ * @param threads,  Ignored.
+ */
+void sortParallel(struct List* list, int threads)
+{
+    (void)threads;
+    sortQuick(list);
+}
+
+/** This function sorts a list for callers that want a parallel sort on their own pool.
+ * The unrolled list is sorted with the quick sort on the calling thread, as sortParallel does.
+ * @param list, The unrolled list to be sorted.
+ * @param pool, Ignored.
+ */
+void sortParallelPool(struct List* list, struct ThreadPool* pool)
+{
+    (void)pool;
+    sortQuick(list);
+}
+
+// Hidden functions
+
+/** This function makes a new empty block, on a cache line of its own.
+ * @return, The block, unlinked, or NULL if there is no memory left.
+ */
+struct ListNode* blockConstructor(void)
+{
+#ifdef _WIN32
+    struct ListNode* block = _aligned_malloc(sizeof(struct ListNode), CACHE_LINE);
+#else
+    struct ListNode* block = aligned_alloc(CACHE_LINE, sizeof(struct ListNode));
+#endif
+
+    if (block != NULL)
+    {
+        block->count = 0;
+        block->next = NULL;
+        block->prev = NULL;
+    }
+    return block;
+}
+
+/** This function frees a block made by blockConstructor.
+ * @param block, The block, already unlinked.
+ */
+void blockDestructor(struct ListNode* block)
+{
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+/** This function inserts an entity part way through a block, splitting the block in half first if it is full.
+ * @param list,     The unrolled list holding the block.
+ * @param block,    The block to insert into.
+ * @param place,    The index within the block the entity should end up at.
+ * @param entity,   The entity to insert.
+ * @return,         The block the entity went into, or NULL if there was no memory to split the block.
+ */
+struct ListNode* insertInBlock(struct List* list, struct ListNode* block, int place, int entity)
+{
+    if (block->count == BLOCK_ENTITIES)
+    {
+        struct ListNode* newBlock = blockConstructor();
+        int half = BLOCK_ENTITIES / 2;
+
+        if (newBlock == NULL)
+        {
+            return NULL;
+        }
+        memcpy(newBlock->entities, &block->entities[half], (BLOCK_ENTITIES - half) * sizeof(int));
+        newBlock->count = BLOCK_ENTITIES - half;
+        block->count = half;
+
+        newBlock->prev = block;
+        newBlock->next = block->next;
+        if (block->next)
+        {
+            block->next->prev = newBlock;
+        }
+        else
+        {
+            list->tail = newBlock;
+        }
+        block->next = newBlock;
+
+        if (place > half)
+        {
+            place -= half;
+            block = newBlock;
+        }
+    }
+    memmove(&block->entities[place + 1], &block->entities[place], (block->count - place) * sizeof(int));
+    block->entities[place] = entity;
+    block->count ++;
+    list->size ++;
+    return block;
+}
+
+/** This function copies every entity of a list into a new array.
+ * @param list, The unrolled list.
+ * @return,     The array, to be freed by the caller, or NULL if there is no memory left.
+ */
+int* gatherEntities(struct List* list)
+{
+    int* array = malloc(list->size * sizeof(int));
+
+    if (array != NULL)
+    {
+        listToArray(list, array);
+    }
+    return array;
+}
+
+/** This function copies an array back over a list's entities, keeping every block's count as it is.
+ * @param list,     The unrolled list.
+ * @param array,    The entities, list->size of them.
+ */
+void scatterEntities(struct List* list, int* array)
+{
+    struct ListNode* block = list->head;
+
+    while (block != NULL)
+    {
+        memcpy(block->entities, array, block->count * sizeof(int));
+        array += block->count;
+        block = block->next;
+    }
+}
+
+/** This function sorts an array using insertion sort.
+ * @param array,    The array to be sorted.
+ * @param size,     The number of entities in it.
+ */
+void insertionSortArray(int* array, int size)
+{
+    int temp;
+    int j;
+
+    for (int i = 1; i < size; i++)
+    {
+        temp = array[i];
+        j = i - 1;
+        while (j >= 0 && array[j] > temp)
+        {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = temp;
+    }
+}
+
+/** This function merges two sorted neighbouring ranges into another array, taking from the left range on equal values.
+ * @param from,     The array holding the two ranges.
+ * @param to,       The array the merged range is written to, at the same place.
+ * @param low,      The start of the left range.
+ * @param middle,   The end of the left range and start of the right range.
+ * @param high,     The end of the right range (exclusive).
+ */
+void mergeArrayRanges(int* from, int* to, int low, int middle, int high)
+{
+    int left = low;
+    int right = middle;
+
+    for (int i = low; i < high; i++)
+    {
+        if (left < middle && (right >= high || from[left] <= from[right]))
+        {
+            to[i] = from[left++];
+        }
+        else
+        {
+            to[i] = from[right++];
+        }
+    }
+}
+
+/** This function sorts part of an array using introsort.
+ * @param array,        The array being sorted.
+ * @param low,          The low limit of the section being sorted.
+ * @param high,         The high limit of the section being sorted.
+ * @param depthLimit,   How many more partitions deep it can go before heap sorting the section.
+ */
+void quickSortArray(int* array, int low, int high, int depthLimit)
+{
+    int middle;
+    int pivot;
+    int i;
+    int j;
+
+    while (high - low + 1 > QUICK_SORT_CUTOFF)
+    {
+        if (depthLimit == 0)
+        {
+            heapSortArray(&array[low], high - low + 1);
+            return;
+        }
+        depthLimit--;
+        middle = low + (high - low) / 2;
+        if (array[middle] < array[low])         // Median of three, ends up in the middle.
+        {
+            swapEntities(&array[middle], &array[low]);
+        }
+        if (array[high] < array[low])
+        {
+            swapEntities(&array[high], &array[low]);
+        }
+        if (array[high] < array[middle])
+        {
+            swapEntities(&array[high], &array[middle]);
+        }
+        pivot = array[middle];
+        i = low - 1;
+        j = high + 1;
+        while (1)
+        {
+            do
+            {
+                i++;
+            } while (array[i] < pivot);
+            do
+            {
+                j--;
+            } while (array[j] > pivot);
+            if (i >= j)
+            {
+                break;
+            }
+            swapEntities(&array[i], &array[j]);
+        }
+        if (j - low < high - j)     // Recurse into the smaller part so the stack stays O(log n).
+        {
+            quickSortArray(array, low, j, depthLimit);
+            low = j + 1;
+        }
+        else
+        {
+            quickSortArray(array, j + 1, high, depthLimit);
+            high = j;
+        }
+    }
+    insertionSortArray(&array[low], high - low + 1);
+}
+
+/** This function swaps two entities.
+ * @param a, The first entity.
+ * @param b, The second entity.
+ */
+void swapEntities(int* a, int* b)
+{
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+/** This function sorts an array using heap sort.
+ * @param array,    The array to be sorted.
+ * @param size,     The number of entities in it.
+ */
+void heapSortArray(int* array, int size)
+{
+    int temp;
+
+    for (int root = size / 2 - 1; root >= 0; root--)
+    {
+        siftDownArray(array, root, size);
+    }
+    for (int end = size - 1; end > 0; end--)
+    {
+        temp = array[0];
+        array[0] = array[end];
+        array[end] = temp;
+        siftDownArray(array, 0, end);
+    }
+}
+
+/** This function moves an entity down a max heap until both its children are no bigger.
+ * @param array,    The heap.
+ * @param root,     The index of the entity to move down.
+ * @param size,     The number of entities in the heap.
+ */
+void siftDownArray(int* array, int root, int size)
+{
+    int temp = array[root];
+    int child;
+
+    while ((child = 2 * root + 1) < size)
+    {
+        if (child + 1 < size && array[child + 1] > array[child])
+        {
+            child++;
+        }
+        if (array[child] <= temp)
+        {
+            break;
+        }
+        array[root] = array[child];
+        root = child;
+    }
+    array[root] = temp;
+}
+
+/** This function turns every strictly descending run of an array around, so the array is all ascending runs.
+ * Only strictly descending runs are turned around so equal entities keep their order.
+ * @param array,    The array.
+ * @param size,     The number of entities in it.
+ */
+void reverseDescendingRuns(int* array, int size)
+{
+    int low = 0;
+    int high;
+    int temp;
+
+    while (low < size)
+    {
+        high = low + 1;
+        while (high < size && array[high] < array[high - 1])
+        {
+            high++;
+        }
+        for (int i = low, j = high - 1; i < j; i++, j--)
+        {
+            temp = array[i];
+            array[i] = array[j];
+            array[j] = temp;
+        }
+        low = high;
+    }
+}
+
+/** This function finds where the ascending run starting at low ends.
+ * @param array,    The array.
+ * @param low,      The start of the run.
+ * @param size,     The number of entities in the array.
+ * @return,         The end of the run (exclusive).
+ */
+int runEnd(int* array, int low, int size)
+{
+    int high = low + 1;
+
+    while (high < size && array[high - 1] <= array[high])
+    {
+        high++;
+    }
+    return high;
+}
+
+/** This function moves a cursor on to the next entity, NULL block once it has gone past the tail.
+ * @param cursor,   The cursor.
+ */
+void cursorNext(struct BlockCursor* cursor)
+{
+    cursor->place ++;
+    while (cursor->block != NULL && cursor->place >= cursor->block->count)
+    {
+        cursor->block = cursor->block->next;
+        cursor->place = 0;
+    }
+}
+
+/** This function moves a cursor back to the entity before, NULL block once it has gone past the head.
+ * @param cursor,   The cursor.
+ */
+void cursorPrev(struct BlockCursor* cursor)
+{
+    cursor->place --;
+    while (cursor->block != NULL && cursor->place < 0)
+    {
+        cursor->block = cursor->block->prev;
+        if (cursor->block != NULL)
+        {
+            cursor->place = cursor->block->count - 1;
+        }
+    }
+}
+
+/** This function sorts a list in place using comb sort, for when there is no memory to copy the entities out.
+ * Bubble sort passes comparing entities a gap apart, the gap shrinking by 1.3 each pass down to 1. Two cursors
+ * walk the blocks the gap apart, so no extra memory is needed. Not stable.
+ * @param list, The unrolled list to be sorted.
+ */
+void combSortBlocks(struct List* list)
+{
+    struct BlockCursor left;
+    struct BlockCursor right;
+    int gap = list->size;
+    int swapped = 1;
+    int temp;
+
+    while (gap > 1 || swapped)
+    {
+        gap = (gap * 10) / 13;
+        if (gap < 1)
+        {
+            gap = 1;
+        }
+        swapped = 0;
+        left.block = list->head;
+        left.place = 0;
+        right = left;
+        for (int i = 0; i < gap; i++)
+        {
+            cursorNext(&right);
+        }
+        for (int i = gap; i < list->size; i++)
+        {
+            if (left.block->entities[left.place] > right.block->entities[right.place])
+            {
+                temp = left.block->entities[left.place];
+                left.block->entities[left.place] = right.block->entities[right.place];
+                right.block->entities[right.place] = temp;
+                swapped = 1;
+            }
+            cursorNext(&left);
+            cursorNext(&right);
+        }
+    }
+    list->isSorted = 1;
+}
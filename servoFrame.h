@@ -0,0 +1,115 @@
+/* Support for writing the ServoList cycle as one function that reads top to bottom.
+ *
+ * With C++20 coroutines the cycle is a coroutine, FRAME_AWAIT_UNTIL suspends it until a Timeout resumes it.
+ * Toolchains without coroutines get a stackless state machine instead, FRAME_AWAIT_UNTIL saves the line it
+ * got to and returns, the next call switches straight back to that line.
+ * Either way nothing is allocated once the cycle has started, so every resume costs the same.
+ *
+ * The state machine has no stack of its own, anything that has to survive a FRAME_AWAIT_UNTIL must be a member.
+ * Define SERVO_COROUTINES as 0 or 1 to choose, otherwise coroutines are used if the compiler has them.
+ */
+#ifndef SERVO_FRAME_H
+#define SERVO_FRAME_H
+
+#ifndef SERVO_COROUTINES
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define SERVO_COROUTINES 1
+#endif
+#endif
+#endif
+#ifndef SERVO_COROUTINES
+#define SERVO_COROUTINES 0
+#endif
+
+#include <cstdint>
+
+#if SERVO_COROUTINES
+
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <type_traits>
+
+/** Handle to a running cycle coroutine. The coroutine starts suspended and is destroyed with this. */
+class Frame
+{
+public:
+    struct promise_type
+    {
+        Frame get_return_object(){ return Frame(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+#if defined(__cpp_exceptions)
+        void unhandled_exception() { std::terminate(); }    // Otherwise the cycle would stop dead at final suspend.
+#else
+        void unhandled_exception() { std::abort(); }
+#endif
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+public:
+    Frame() : handle_(nullptr) {}
+    explicit Frame(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Frame(Frame &&other) : handle_(other.handle_) { other.handle_ = nullptr; }
+    Frame& operator = (Frame &&other)
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    Frame(const Frame&) = delete;
+    Frame& operator = (const Frame&) = delete;
+    ~Frame(){ if (handle_) { handle_.destroy(); } }
+
+    /** Carries on from the last FRAME_AWAIT_UNTIL. */
+    void resume(){ if (handle_ && !handle_.done()) { handle_.resume(); } }
+};
+
+/** What FRAME_AWAIT_UNTIL waits on. wake(time) attaches the Timeout and returns false if the time has already passed. */
+template <typename T>
+struct FrameAwait
+{
+    T *owner;
+    uint32_t time;
+
+    bool await_ready() { return false; }
+    bool await_suspend(std::coroutine_handle<>) { return owner->wakeAt(time); }
+    void await_resume() {}
+};
+
+#define FRAME_BEGIN
+#define FRAME_AWAIT_UNTIL(time) co_await FrameAwait<typename std::remove_pointer<decltype(this)>::type>{this, (time)}
+#define FRAME_END co_return
+
+#else
+
+/** The cycle function returns nothing as a state machine, frameState_ holds where it got to. */
+typedef void Frame;
+
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(fallthrough)
+#define FRAME_FALLTHROUGH [[fallthrough]]
+#endif
+#endif
+#ifndef FRAME_FALLTHROUGH
+#define FRAME_FALLTHROUGH
+#endif
+
+#define FRAME_BEGIN switch (frameState_) { case 0:
+#define FRAME_AWAIT_UNTIL(time) do { frameState_ = __LINE__; if (wakeAt(time)) { return; } FRAME_FALLTHROUGH; case __LINE__:; } while (0)
+#define FRAME_END } frameState_ = 0; return
+
+#endif
+
+#endif
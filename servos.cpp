@@ -1,41 +1,68 @@
 #include "servos.h"
 #include <cstdint>
 
+//Methods for the ServoPin class.
+
+void ServoList::ServoPin::off()
+{
+    uint32_t start = us_ticker_read();
+    out_ = false;
+    *busyTime_ += us_ticker_read() - start;
+}
+
 //Methods for the ServoNode class.
 
-ServoList::ServoNode::ServoNode(PinName pinNo, uint16_t index, uint8_t position) :
-    out_(pinNo),
-    index_(index)
+ServoList::ServoNode::ServoNode() :
+    position_(0),
+    index_(0),
+    onTime_(0),
+    pin_(nullptr)
+{
+}
+
+ServoList::ServoNode::ServoNode(PinName pinNo, uint16_t index, uint32_t *busyTime) :
+    position_(0),
+    index_(index),
+    onTime_(0),
+    pin_(new ServoPin(pinNo, busyTime))
 {
-    *this = position;
 }
 
-void ServoList::ServoNode::setPosition(uint8_t position)
+void ServoList::ServoNode::setPosition(uint8_t position, std::chrono::microseconds onTime)
 {
     position_ = position;
-    std::chrono::microseconds ontime = MINONTIME + ((MAXONTIME - MINONTIME) * position / 256);
-    onTime_ = ontime;
+    onTime_ = onTime;
     //offTime_ = CYCLETIME - onTime_;
 }
 
 void ServoList::ServoNode::operator = (bool switcher)
 {
-    out_ = switcher;
     if(switcher)
     {
-        timer_.attach( callback( this, &ServoNode::off), onTime_);
+        on();
+    } else
+    {
+        off();
     }
 }
 
 void ServoList::ServoNode::on()
 {
-    out_ = true;
-    timer_.attach( callback( this, &ServoNode::off), onTime_);
+    pin_->out_ = true;
+    pin_->offTimer_.attach( callback( pin_, &ServoPin::off), onTime_);
 }
 
-void ServoList::ServoNode::setTimer(Timeout *timer)
+void ServoList::ServoNode::off()
 {
-    timerptr_ = timer;
+    pin_->offTimer_.detach();
+    pin_->out_ = false;
+}
+
+void ServoList::ServoNode::release()
+{
+    off();
+    delete pin_;
+    pin_ = nullptr;
 }
 
 
@@ -45,19 +72,45 @@ ServoList::ServoList(std::chrono::microseconds minOnTime ,
                      std::chrono::microseconds onTimeLen , 
                      std::chrono::microseconds cycleTime ,
                      uint16_t minOnTimeInt ): 
+    busyTime_(0),
     noOfServos_(0),
     running_(false)
 {
-    isSorted_ = false;
+    dirtyGroups_ = 0;
     counter_ = 0;
+    frameStart_ = 0;
+    lastBusyTime_ = 0;
+    framePin_ = nullptr;
+    inFrame_ = false;
+#if !SERVO_COROUTINES
+    frameState_ = 0;
+#endif
     MINONTIME = minOnTime;
     MAXONTIME = onTimeLen;
     GROUPTIME = MINONTIME + MAXONTIME;
-    MAXSERVOS = NUMBEROFGROUPS * GROUPSIZE;
     CYCLETIME = cycleTime;
     MINONTIMEINT = minOnTimeInt;
     GROUPSIZE = minOnTimeInt / ITRPTTIME;
-    ServoNode::setTimer(&timer_);
+    MAXSERVOS = NUMBEROFGROUPS * GROUPSIZE;
+    for (int i = 0; i < NUMBEROFGROUPS; i++)
+    {
+        list_[i] = new ServoNode[GROUPSIZE];
+    }
+}
+
+ServoList::~ServoList()
+{
+    end();
+    timer_.detach();
+    for (int i = 0; i < noOfServos_; i++)
+    {
+        at(i).release();
+    }
+    for (int i = 0; i < NUMBEROFGROUPS; i++)
+    {
+        delete[] list_[i];
+    }
+    delete framePin_;
 }
 
 // Public methods.
@@ -70,57 +123,57 @@ int ServoList::add(PinName pinNo, uint8_t position, uint16_t index)
     }
     int quotient = noOfServos_ / GROUPSIZE;
     int remainder = noOfServos_ % GROUPSIZE;
-    ServoNode servo(pinNo, index, position);
+    ServoNode servo(pinNo, index, &busyTime_);
+    servo.setPosition(position, onTimeFor(position));
+    __disable_irq();
     list_[quotient][remainder] = servo;
     noOfServos_++;
-    isSorted_ = false;
+    dirtyGroups_ |= 1u << quotient;
+    __enable_irq();
     return 1;
 }
 
 int ServoList::remove(int index)
 {
-    bool removeCheck = false;
-    for (int i = 0; i < NUMBEROFGROUPS; i++) 
+    int place = -1;
+    for (int i = 0; i < noOfServos_; i++)     // Find where the servo is held.
     {
-        for (int j = 0; j < GROUPSIZE; j++) 
+        if (at(i).getIndex() == index)
         {
-            if (list_[i][j].getIndex() == index) 
-            {
-                __disable_irq();
-                removeCheck = true;
-                if (j < GROUPSIZE - 1) 
-                {
-                    list_[i][j] = list_[i][j + 1];      // Move next servo down.
-                    list_[i][j + 1].setIndex(index);    // Allow to repeat on next servo.
-                    list_[i][j + 1].setPosition(NULL);  // Make the last servo not turn on in the run function.
-                } else 
-                {
-                    list_[i][j] = list_[i + 1][0];      // Move next servo down (from next group).
-                    list_[i + 1][0].setIndex(index);    // Allow to repeat on next servo (in next group).
-                    list_[i + 1][0].setPosition(NULL);  // Make the last servo not turn on in the run function.
-                }
-            }
-        }
-        if(removeCheck)
-        {
-            __enable_irq();
-            sortSorted(i);  // Only one out of place.
+            place = i;
+            break;
         }
     }
-    if (removeCheck)    // Something has been removed
+    if (place < 0)
     {
-        noOfServos_--;
-        return 1;
+        return 0;           // Nothing has been removed (failed to find servo in list)
     }
-    return 0;           // Nothing has been removed (failed to find servo in list)
+
+    __disable_irq();
+    at(place).release();
+    for (int i = place; i < noOfServos_ - 1; i++)
+    {
+        at(i) = at(i + 1);                  // Move next servo down, from the next group at the end of a group.
+    }
+    at(noOfServos_ - 1) = ServoNode();      // Empty the last place.
+    noOfServos_--;
+    dirtyGroups_ |= (ALLGROUPS << (place / GROUPSIZE)) & ALLGROUPS;    // Every group after the gap has moved.
+    __enable_irq();
+    return 1;
 }
+
 void ServoList::start()
 {
     if(!running_)
     {
         running_ = true;
-        counter_ = 0;
-        run();
+        if(!inFrame_)       // Otherwise the last cycle hasn't noticed end() yet and will just carry on.
+        {
+#if SERVO_COROUTINES
+            frame_ = frame();
+#endif
+            resume();
+        }
     }
 }
 
@@ -132,29 +185,32 @@ void ServoList::end()
 void ServoList::updatePosition(uint16_t index, uint8_t position)
 {
     bool found = false;
-    for (int i = 0; (i < NUMBEROFGROUPS) && (!found); i++) //Search the list until it's found
+    int groups = groupCount();
+    for (int i = 0; (i < groups) && (!found); i++) //Search the list until it's found
     {
-        for (int j = 0; (j < GROUPSIZE) && (!found); j++)  //Search each group until it's found
+        int NoServos = groupLength(i);
+        for (int j = 0; (j < NoServos) && (!found); j++)  //Search each group until it's found
         {
             if (list_[i][j].getIndex() == index) 
             {
-                list_[i][j] = position;
+                __disable_irq();
+                list_[i][j].setPosition(position, onTimeFor(position));
+                dirtyGroups_ |= 1u << i;    // Sorted before the group is next turned on, not here.
+                __enable_irq();
                 found = true;
             }
         }
-        if(found)
-        {
-            sortSorted(i);
-        }
     }
 }
 
 void ServoList::updateIndex(uint16_t oldIndex, uint16_t newIndex)
 {
     bool found = false;
-    for (int i = 0; (i < NUMBEROFGROUPS) && (!found); i++) //Search the list until it's found
+    int groups = groupCount();
+    for (int i = 0; (i < groups) && (!found); i++) //Search the list until it's found
     {
-        for (int j = 0; (j < GROUPSIZE) && (!found); j++)  //Search each group until it's found
+        int NoServos = groupLength(i);
+        for (int j = 0; (j < NoServos) && (!found); j++)  //Search each group until it's found
         {
             if (list_[i][j].getIndex() == oldIndex) 
             {
@@ -167,9 +223,11 @@ void ServoList::updateIndex(uint16_t oldIndex, uint16_t newIndex)
 
 uint8_t ServoList::getPosition(uint16_t index)
 {
-    for (int i = 0; (i < NUMBEROFGROUPS); i++) //Search the list 
+    int groups = groupCount();
+    for (int i = 0; (i < groups); i++) //Search the list 
     {
-        for (int j = 0; (j < GROUPSIZE); j++)  //Search each group 
+        int NoServos = groupLength(i);
+        for (int j = 0; (j < NoServos); j++)  //Search each group 
         {
             if (list_[i][j].getIndex() == index) 
             {
@@ -177,80 +235,163 @@ uint8_t ServoList::getPosition(uint16_t index)
             }
         }
     }
-    return NULL;    // index not found, error.
+    return 0;       // index not found, error.
 }
 
-// Private methods.
-
-void ServoList::run()
+std::chrono::microseconds ServoList::timeToNextEdge()
 {
-    if(!isSorted_)
+    uint32_t elapsed = us_ticker_read() - frameStart_;     // Time since the start of this cycle.
+    uint32_t next = CYCLETIME.count();                      // The next cycle starting is always an edge.
+    int groups = groupCount();
+    for (int i = 0; i < groups; i++)
     {
-        int groups = noOfServos_ / GROUPSIZE;
-        for(int i = 0; i < groups - 1; i++)
+        int NoServos = groupLength(i);
+        for (int j = 0; j < NoServos; j++)
         {
-            sortUnsorted(i);
+            uint32_t onEdge = (GROUPTIME * i).count() + (ITRPTTIME * j);
+            uint32_t offEdge = onEdge + list_[i][j].getOnTime().count();
+            if (onEdge > elapsed && onEdge < next)
+            {
+                next = onEdge;
+            }
+            if (offEdge > elapsed && offEdge < next)
+            {
+                next = offEdge;
+            }
         }
     }
-    __disable_irq();    // This is the most crucial part for the timing, nothing can interrupt this.
-    if(running_)
+    if (next <= elapsed)
     {
-        timer_.attach( callback( this, &ServoList::run), CYCLETIME);     // Start the process again in 20ms
-        int groups = noOfServos_ / GROUPSIZE;
-        for(int i = 0; i < groups - 1; i++)                             // Turn on each group sequentially 
+        return 0us;     // Already late, the ISR is pending.
+    }
+    return std::chrono::microseconds(next - elapsed);
+}
+
+void ServoList::sleepUntilNextEdge()
+{
+    if (!running_)
+    {
+        sleep();        // Nothing scheduled, wait for any interrupt.
+        return;
+    }
+    uint32_t wakeTime = us_ticker_read() + timeToNextEdge().count();
+    do
+    {
+        sleep();        // Woken by any interrupt, go back to sleep if it wasn't ours.
+    } while ((int32_t)(us_ticker_read() - wakeTime) < 0);
+}
+
+// Private methods.
+
+Frame ServoList::frame()
+{
+    FRAME_BEGIN;
+    inFrame_ = true;
+    while(running_)
+    {
+        planCycle();
+
+        for(counter_ = 0; counter_ < groupCount(); counter_++)       // Turn on each group sequentially
         {
-            timer_.attach( callback( this, &ServoList::nextGroupOn), GROUPTIME*(i+1));       
+            FRAME_AWAIT_UNTIL(frameStart_ + (uint32_t)(GROUPTIME * counter_).count());
+            groupOn(counter_);
         }
+
+        FRAME_AWAIT_UNTIL(frameStart_ + (uint32_t)CYCLETIME.count());       // Start the process again in 20ms
+        finishCycle();
     }
-    __enable_irq();
+    inFrame_ = false;
+    FRAME_END;
 }
 
-void ServoList::nextGroupOn()
+void ServoList::resume()
 {
-    int groups = noOfServos_ / GROUPSIZE;    // How many groups are currently held.
-    groupOn(counter_);
-    if(counter_ < groups)
+    uint32_t start = us_ticker_read();
+#if SERVO_COROUTINES
+    frame_.resume();
+#else
+    frame();
+#endif
+    busyTime_ += us_ticker_read() - start;
+}
+
+bool ServoList::wakeAt(uint32_t time)
+{
+    int32_t delay = (int32_t)(time - us_ticker_read());
+    if(delay <= 0)
     {
-        counter_++;
-    } else {
-        counter_ = 0;
+        return false;       // Already late, don't wait.
     }
+    timer_.attach( callback( this, &ServoList::resume), std::chrono::microseconds(delay));
+    return true;
 }
 
-void ServoList::groupOn(int groupNo)
+void ServoList::planCycle()
 {
-    int NoServos = GROUPSIZE;
-    int groups = noOfServos_ / GROUPSIZE;    // How many groups are currently held.
-    if(groupNo == groups - 1)
+    if(framePin_)
     {
-        NoServos = noOfServos_ % GROUPSIZE;  // If the end group, find the number in the group.
-    } 
-    if(!isSorted_)
+        *framePin_ = true;
+    }
+    frameStart_ = us_ticker_read();
+    uint32_t dirty = dirtyGroups_;
+    dirtyGroups_ = 0;
+    while(dirty)
+    {
+        int groupNo = __builtin_ctz(dirty);     // Lowest changed group first.
+        dirty &= dirty - 1;
+        sortUnsorted(groupNo);
+    }
+    if(framePin_)
+    {
+        *framePin_ = false;
+    }
+}
+
+void ServoList::finishCycle()
+{
+    __disable_irq();
+    lastBusyTime_ = busyTime_;      // The cycle has finished, keep its total.
+    busyTime_ = 0;
+    __enable_irq();
+}
+
+void ServoList::groupOn(int groupNo)
+{
+    int NoServos = groupLength(groupNo);
+    if(dirtyGroups_ & (1u << groupNo))  // Changed since the cycle was planned.
     {
+        dirtyGroups_ &= ~(1u << groupNo);
         sortSorted(groupNo);
     }
-    for(int j = 0; ; j++)
+    for(int j = 0; j < NoServos; j++)
     {
-        if(list_[groupNo][j].getPosition() != NULL) // There should never be a NULL value if everything is done right, does this need to be here?
-        {
-            list_[groupNo][j].on();
-            wait_us(ITRPTTIME);     // Wait for the time taken for an ISR to complete so the off ISRs don't clash on servos with close times.
-        }
+        list_[groupNo][j].on();
+        wait_us(ITRPTTIME);     // Wait for the time taken for an ISR to complete so the off ISRs don't clash on servos with close times.
     }
 }
 
-void ServoList::sortSorted(int groupNo)
+int ServoList::groupCount()
+{
+    return (noOfServos_ + GROUPSIZE - 1) / GROUPSIZE;
+}
+
+int ServoList::groupLength(int groupNo)
 {
-    bool changed;
-    int numEntities;
-    
     if(groupNo < (noOfServos_ / GROUPSIZE))
     {
-        numEntities = GROUPSIZE;                // Full group of servos
-    } else
+        return GROUPSIZE;                       // Full group of servos
+    }
+    if(groupNo == (noOfServos_ / GROUPSIZE))
     {
-        numEntities = noOfServos_ % GROUPSIZE;   // Find the number of servos in the last group
+        return noOfServos_ % GROUPSIZE;         // Find the number of servos in the last group
     }
+    return 0;                                   // Past the end, emptied since the cycle started.
+}
+
+void ServoList::sortSorted(int groupNo)
+{
+    bool changed;
+    int numEntities = groupLength(groupNo);
 
     __disable_irq();
     do
@@ -258,53 +399,33 @@ void ServoList::sortSorted(int groupNo)
         changed = false;
         for(int i = 1; i < numEntities; i++)
         {
-            if(list_[groupNo][i].getOnTime() > list_[groupNo][i+1].getOnTime()) // Are they in the wrong order?
+            if(list_[groupNo][i-1].getOnTime() > list_[groupNo][i].getOnTime()) // Are they in the wrong order?
             {                                                                   // Then swap them.
-                ServoNode temp = list_[groupNo][i];
-                list_[groupNo][i] = list_[groupNo][i+1];
-                list_[groupNo][i+1] = temp;
+                ServoNode temp = list_[groupNo][i-1];
+                list_[groupNo][i-1] = list_[groupNo][i];
+                list_[groupNo][i] = temp;
                 changed = true;         // Something has changed don't end sorting
             }
         }
-    }while ( !changed ); // Stops when sorting is complete. i.e. when nothing has changed on a full pass.
-    isSorted_ = true;
+    }while ( changed ); // Stops when sorting is complete. i.e. when nothing has changed on a full pass.
     __enable_irq();
 }
 
 void ServoList::sortUnsorted(int groupNo)
 {
-    int added;
-    int numEntities;
-    if (groupNo < (noOfServos_ / GROUPSIZE)) 
-    {
-        numEntities = GROUPSIZE;                // Full group of servos.
-    } else 
-    {
-        numEntities = noOfServos_ % GROUPSIZE;   // Find number of servos in the last group.
-    }
+    int numEntities = groupLength(groupNo);
     __disable_irq();
 
-    for (int i = 0; i < numEntities; i++) 
+    for (int i = 1; i < numEntities; i++) 
     {
         ServoNode temp = list_[groupNo][i]; // Pick up and 'hold' servo
-        added = 0;
-        for (int j = i - 1; j >= 0; j--) 
+        int j = i - 1;
+        while (j >= 0 && list_[groupNo][j].getOnTime() > temp.getOnTime()) // Is it longer than the held servo?
         {
-            if (added == 0) 
-            {
-                if (temp.getOnTime() > list_[groupNo][j].getOnTime()) // Is it longer than the held servo?
-                {
-                    list_[groupNo][j + 1] = list_[groupNo][j];  // Move up next servo in list
-                } else 
-                {
-                    list_[groupNo][j] = temp;                   // Put down held servo
-                    added = 1;
-                }
-            }
+            list_[groupNo][j + 1] = list_[groupNo][j];  // Move up next servo in list
+            j--;
         }
+        list_[groupNo][j + 1] = temp;                   // Put down held servo
     }
     __enable_irq();
-    isSorted_ = true;
 }
-
-
@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <chrono>
 
+#include "servoFrame.h"
 
 /** Servo list class 
  *  2D array list type
@@ -11,6 +12,25 @@
 class ServoList 
 {
 private:
+    /** The output side of a servo. Kept on the heap so that the off callback still turns off
+     * the right pin when the sorts move the ServoNodes around mid cycle.
+    */
+    class ServoPin
+    {
+    public:
+        DigitalOut out_;                        // The pin that the servo is attached to.
+        Timeout offTimer_;                      // Timeout for the off callback.
+        uint32_t *busyTime_;                    // The list's count of time spent in the ISRs.
+
+        /** Constructor for ServoPin class.
+         * @param pinNo, The pin name for the digital out attached to the servo.
+         * @param busyTime, The busyTime_ of the list the servo is in.
+         */
+        ServoPin(PinName pinNo, uint32_t *busyTime) : out_(pinNo), busyTime_(busyTime) {}
+
+        /** Turn off the DigitalOut out_ variable, this is the off callback. */ void off();
+    };
+
     /** Single servo data structure
     */
     class ServoNode
@@ -20,39 +40,39 @@ private:
         uint16_t index_;                        // Index of the servo according to the user.
         std::chrono::microseconds onTime_;      // Length of time the servo is on for.
         //std::chrono::microseconds offTime_;     // Length of time the servo is off for. Do I need this?
-        DigitalOut out_;                        // The pin that the servo is attached to.
-        static Timeout* timerptr_;                     // The pointer to the Timeout for callbacks
+        ServoPin *pin_;                         // The pin and Timeout of this servo, NULL for an empty place.
 
     public:
+        /** Constructor for an empty servoNode, used to fill the unused places in the list.
+         */
+        ServoNode();
+
         /** Constructor for servoNode class
          * Not intended for use seperate from ServoList class
          *
          * @param pinNo, The pin name for the digital out attached to the servo.
          * @param index, The index specified by the user.
-         * @param timerptr, The pointer to the Timeout for callbacks.
-         * @param position, position to initialised the servo to. Default to 128 for no input.
+         * @param busyTime, The busyTime_ of the list the servo is in.
          */
-        ServoNode(PinName pinNo, uint16_t index, uint8_t position = 128);
+        ServoNode(PinName pinNo, uint16_t index, uint32_t *busyTime);
 
-        /** Returns the value of the index_ variable. */ uint8_t getIndex(){ return index_; }
+        /** Returns the value of the index_ variable. */ uint16_t getIndex(){ return index_; }
 
         /** Returns the value of the onTime_ variable. */ std::chrono::microseconds getOnTime(){ return onTime_; }
 
         /** Returns the value of the position_ variable.*/ int getPosition(){ return position_; }
 
-        /** Updates the index_ variable.*/ void setIndex(uint8_t index){ index_ = index; }
+        /** Updates the index_ variable.*/ void setIndex(uint16_t index){ index_ = index; }
         
-        /** operator overload that allows a quick way to use setPosition method.*/ void operator = (uint8_t position){ setPosition(position); }
-
-        /** Turn off the DigitalOut out_variable. */ void off(){ out_ = false; }
+        /** Turn off the servo's pin. */ void off();
 
-        /** Turn on the DigitalOut out_ variable. */ void on();
+        /** Turn on the servo's pin and start its off Timeout. */ void on();
 
-        /** Either turns out_ on or off. */ void operator = (bool switcher);
+        /** Either turns the pin on or off. */ void operator = (bool switcher);
         
-        /** Updates the position_, onTime_ and offTime_ variables. */ void setPosition(uint8_t position);
+        /** Updates the position_ and onTime_ variables, the list works out the on time. */ void setPosition(uint8_t position, std::chrono::microseconds onTime);
 
-        /** passes the pointer to the timer into the ServoNode class. */ static void setTimer(Timeout *timer);
+        /** Turns the pin off and frees it, only call once the node is being taken out of the list. */ void release();
     };
 
 // ServoList class starts here
@@ -60,37 +80,71 @@ private:
     /* Static member variable*/
     static const uint8_t ITRPTTIME = 100;                           // Length of time taken to service interrupt in us.
     static const uint8_t NUMBEROFGROUPS = 6;                        // Number of groups possible.
-
-    static std::chrono::microseconds CYCLETIME;                     // The length of time before the next cycle will start.
-    static std::chrono::microseconds MINONTIME;                     // The minimum on time for these servos.
-    static uint16_t MINONTIMEINT;                                   // The minimum on time for these servos in us.
-    static std::chrono::microseconds MAXONTIME;                     // The maximum on time for these servos.
-    static std::chrono::microseconds GROUPTIME;                     // Length of time taken to guarentee no clashes.
-    static uint8_t GROUPSIZE;                                       // Number of servos in each group.
-    static uint16_t MAXSERVOS;                                      // The total number of servos that can be stored.
-    static Timeout timer_;                                           // Timeout that all callbacks use
+    static const uint32_t ALLGROUPS = (1u << NUMBEROFGROUPS) - 1;   // A dirtyGroups_ bit for every group.
+    static_assert(NUMBEROFGROUPS < 32, "dirtyGroups_ has one bit per group");
+
+    /* Timings, set by the constructor, each list has its own so several can run side by side*/
+    std::chrono::microseconds CYCLETIME;                            // The length of time before the next cycle will start.
+    std::chrono::microseconds MINONTIME;                            // The minimum on time for these servos.
+    uint16_t MINONTIMEINT;                                          // The minimum on time for these servos in us.
+    std::chrono::microseconds MAXONTIME;                            // The maximum on time for these servos.
+    std::chrono::microseconds GROUPTIME;                            // Length of time taken to guarentee no clashes.
+    uint8_t GROUPSIZE;                                              // Number of servos in each group.
+    uint16_t MAXSERVOS;                                             // The total number of servos that can be stored.
 
     /* Non-static member variables*/
+    Timeout timer_;                     // Timeout that resumes the cycle.
+    uint32_t busyTime_;                 // Time spent in the ISRs so far this cycle, in us.
     uint16_t noOfServos_;               // no of servos currently held in the list.
     uint8_t counter_;                   // Counter for turning on the groups in order.
     bool running_;                      // Switch for running the main loop.
-    bool isSorted_;                     // A checker for when the whole list is completely sorted.
+    uint32_t dirtyGroups_;              // Bit i is set while group i may be out of order, cleared once it is sorted.
+    uint32_t frameStart_;               // us_ticker time that the current cycle started at.
+    uint32_t lastBusyTime_;             // Time spent in the ISRs during the last full cycle, in us.
+    DigitalOut *framePin_;              // Optional debug pin, high while the start of a cycle is being handled.
+    bool inFrame_;                      // True while the cycle is between FRAME_BEGIN and FRAME_END.
+#if SERVO_COROUTINES
+    Frame frame_;                       // The cycle coroutine.
+    template <typename T> friend struct FrameAwait;
+#else
+    uint16_t frameState_;               // The line the cycle state machine is waiting on, 0 to start.
+#endif
     ServoNode *list_[NUMBEROFGROUPS];   // 2D array-type list containing the servo data.
 
     
-    /** The main function of this program. Turns on all servo pins for the correct length of time.
+    /** The main function of this program. Turns on all servo pins for the correct length of time,
+     * one phase after another, waiting on the Timeout in between. Keeps going until end() is called.
+     */
+    Frame frame();
+
+    /** Callback for the Timeout, carries on the cycle from where it was waiting.
      */
-    void run();
+    void resume();
 
-    /** Callback wrapper for groupOn. Calls the next groupOn in the rotation and handles the inputs.
+    /** Sets the Timeout to resume the cycle at a us_ticker time.
+     * @param time, The us_ticker time to carry on at.
+     * @return, false if the time has already passed and the cycle should carry straight on.
      */
-    void nextGroupOn();
+    bool wakeAt(uint32_t time);
 
-    /** Smaller sub-method for the run method, turns on the servos in one individual group.
+    /** Planning phase, marks the start of the cycle and sorts the groups that have changed, and only those.
+     */
+    void planCycle();
+
+    /** Telemetry phase, keeps the busy time of the cycle that has just finished.
+     */
+    void finishCycle();
+
+    /** Smaller sub-method for the frame method, turns on the servos in one individual group.
      * @param groupNo, The group of servos to be turned on.
      */
     void groupOn(int groupNo);
 
+    /** Returns the servo at a place in the list, counting through the groups in order.
+     * @param place, 0 <= place < MAXSERVOS.
+     */
+    ServoNode& at(int place){ return list_[place / GROUPSIZE][place % GROUPSIZE]; }
+
     /** Sorts a group of servo motors that is mostly sorted. Uses Bubble sort.
      * @param groupNo, The group of servos to be sorted.
      */
@@ -101,6 +155,19 @@ private:
      */
     void sortUnsorted(int groupNo);
 
+    /** Works out how long a servo is on for at a position.
+     * @param position, The position of the servo.
+     */
+    std::chrono::microseconds onTimeFor(uint8_t position){ return MINONTIME + ((MAXONTIME - MINONTIME) * position / 256); }
+
+    /** Returns the number of groups currently holding servos, including a part filled last group. */
+    int groupCount();
+
+    /** Returns the number of servos held in a group.
+     * @param groupNo, The group being checked.
+     */
+    int groupLength(int groupNo);
+
 public:
     /** Constructor method for ServoList class 
      * @param minOnTime, The minimum on time for your servos. Default 500us
@@ -109,18 +176,22 @@ public:
      * @param minOnTimeInt, The minimum on time for your servos, in microseconds. !!Must be the same as minOnTime!!. 
      */
     ServoList(std::chrono::microseconds minOnTime = 500us , 
-              std::chrono::microseconds onTimeLen = 2500ms, 
+              std::chrono::microseconds onTimeLen = 2500us, 
               std::chrono::microseconds cycleTime = 20ms,
               uint16_t minOnTimeInt = 500);
 
+    /** Destructor, stops the servos and frees every pin. */
+    ~ServoList();
+
     /** Appends a new servo to the list of servos, iff maximum number of servos not reached.
      * @param pinNo, The PinName of the DigitalOut pin attached to the servo
      * @param position, The starting position of the servo
      * @param index, Index of the servo for later reference */
     int add(PinName pinNo, uint8_t position, uint16_t index);
 
-    /** Removes the servo with the correct pinNo, 
+    /** Removes the servo with the correct index, 
      * fills the gap by pulling the rest of the data forwards one. 
+     * A servo pulled forward into a group that has already been turned on this cycle misses one cycle.
      * @param index, The index of the servo to be removed from the list*/ int remove(int index);
 
     /** Entry point to start the main loop. */ void start();
@@ -132,17 +203,48 @@ public:
     /** Update the index_ of servo [oldIndex] */ void updateIndex(uint16_t oldIndex, uint16_t newIndex);
 
     /** Find the position of servo [index] */ uint8_t getPosition(uint16_t index);
+
+// Idle handling
+
+    /** Time left until the next rising or falling edge this list has scheduled.
+     * Anything the main loop does that is shorter than this will not delay a servo.
+     */
+    std::chrono::microseconds timeToNextEdge();
+
+    /** Puts the core to sleep until the next scheduled edge has been serviced.
+     * Use this in place of an empty while(true) loop, the ISRs wake the core up.
+     */
+    void sleepUntilNextEdge();
+
+    /** Percentage of the last full cycle spent inside the servo ISRs. */
+    float getUtilisation(){ return (100.0f * lastBusyTime_) / CYCLETIME.count(); }
+
 //Getters and setters
 
-    /** Updates the static variable that sets the total time for a full on and off cycle*/
+    /** Sets a spare pin to mark the start of every cycle, for a scope or the simulator's VCD output.
+     * @param pinNo, The PinName of the DigitalOut pin to use.
+     */
+    void setFramePin(PinName pinNo){ delete framePin_; framePin_ = new DigitalOut(pinNo); }
+
+    /** Updates the variable that sets the total time for a full on and off cycle*/
     void setCycleTime(std::chrono::microseconds cycleTime){ CYCLETIME = cycleTime; }
 
-    /** Updates the static variable that sets the minimum time a servo can be on*/
+    /** Updates the variable that sets the minimum time a servo can be on*/
     void setMinOnTime(std::chrono::microseconds minOnTime){ MINONTIME = minOnTime; GROUPTIME = MAXONTIME + MINONTIME; }
 
-    /** Updates the static variable that sets the maximum time a servo can be on*/
+    /** Updates the variable that sets the maximum time a servo can be on*/
     void setOnTimeLen(std::chrono::microseconds maxOnTime){ MAXONTIME = maxOnTime; GROUPTIME = MAXONTIME + MINONTIME; }
 
+    /** Returns the value of the MINONTIME variable. */ std::chrono::microseconds getMinOnTime(){ return MINONTIME; }
+
+    /** Returns the value of the MAXONTIME variable. */ std::chrono::microseconds getMaxOnTime(){ return MAXONTIME; }
+
+    /** Returns the value of the GROUPTIME variable, the time between one group turning on and the next. */ std::chrono::microseconds getGroupTime(){ return GROUPTIME; }
+
+    /** Returns the value of the GROUPSIZE variable. */ int getGroupSize(){ return GROUPSIZE; }
+
+    /** Returns the value of the MAXSERVOS variable. */ int getMaxServos(){ return MAXSERVOS; }
+
 
 // For further work only
 
@@ -169,4 +271,4 @@ public:
     }*/
 
     
-};
\ No newline at end of file
+};